@@ -62,52 +62,21 @@ app_print_result (void)
     {
       if (options.app_data.extended)
         {
-          if (options.common_data.quoted_output)
-            {
-              gchar *buf;
+          gchar *icon = g_icon_to_string (g_app_info_get_icon (info));
 
-              buf = g_shell_quote (g_app_info_get_name (info));
-              g_printf ("%s%s", buf, options.common_data.separator);
-              g_free (buf);
+          yad_output_string (g_app_info_get_name (info));
+          yad_output_string (g_app_info_get_display_name (info));
+          yad_output_string (g_app_info_get_description (info));
+          yad_output_string (icon);
+          yad_output_string (g_app_info_get_executable (info));
+          yad_output_row_end (TRUE);
 
-              buf = g_shell_quote (g_app_info_get_display_name (info));
-              g_printf ("%s%s", buf, options.common_data.separator);
-              g_free (buf);
-
-              buf = g_shell_quote (g_app_info_get_description (info));
-              g_printf ("%s%s", buf, options.common_data.separator);
-              g_free (buf);
-
-              buf = g_shell_quote (g_icon_to_string (g_app_info_get_icon (info)));
-              g_printf ("%s%s", buf, options.common_data.separator);
-              g_free (buf);
-
-              buf = g_shell_quote (g_app_info_get_executable (info));
-              g_printf ("%s%s", buf, options.common_data.separator);
-              g_free (buf);
-
-              g_printf ("\n");
-            }
-          else
-            {
-              g_printf ("%s%s%s%s%s%s%s%s%s%s\n",
-                        g_app_info_get_name (info), options.common_data.separator,
-                        g_app_info_get_display_name (info), options.common_data.separator,
-                        g_app_info_get_description (info), options.common_data.separator,
-                        g_icon_to_string (g_app_info_get_icon (info)), options.common_data.separator,
-                        g_app_info_get_executable (info), options.common_data.separator);
-            }
+          g_free (icon);
         }
       else
         {
-          if (options.common_data.quoted_output)
-            {
-              gchar *buf = g_shell_quote (g_app_info_get_executable (info));
-              g_printf ("%s\n", buf);
-              g_free (buf);
-            }
-          else
-            g_printf ("%s\n", g_app_info_get_executable (info));
+          yad_output_string (g_app_info_get_executable (info));
+          yad_output_row_end (FALSE);
         }
     }
 }
@@ -127,5 +127,8 @@ calendar_print_result (void)
   gtk_calendar_get_date (GTK_CALENDAR (calendar), &year, &month, &day);
   date = g_date_new_dmy (day, month + 1, year);
   g_date_strftime (time_string, 127, options.common_data.date_format, date);
-  g_print ("%s\n", time_string);
+  g_date_free (date);
+
+  yad_output_plain (time_string);
+  yad_output_row_end (FALSE);
 }
@@ -228,5 +228,9 @@ color_print_result (void)
   cs = get_color (&c);
 
   if (cs)
-    g_printf ("%s\n", cs);
+    {
+      yad_output_plain (cs);
+      yad_output_row_end (FALSE);
+      g_free (cs);
+    }
 }
@@ -53,8 +53,9 @@ drop_data_cb (GtkWidget * w, GdkDragContext * dc, gint x, gint y,
             }
           else
             {
-              g_printf ("%s\n", dstr);
-              fflush (stdout);
+              yad_output_plain (dstr);
+              yad_output_row_end (FALSE);
+              yad_output_flush ();
             }
           g_free (dstr);
           i++;
@@ -83,8 +84,9 @@ drop_data_cb (GtkWidget * w, GdkDragContext * dc, gint x, gint y,
             }
           else
             {
-              g_printf ("%s\n", dstr);
-              fflush (stdout);
+              yad_output_plain (dstr);
+              yad_output_row_end (FALSE);
+              yad_output_flush ();
             }
           g_free (dstr);
           g_free (str);
@@ -304,15 +304,20 @@ entry_print_result (void)
   if (options.entry_data.numeric)
     {
       guint prec = gtk_spin_button_get_digits (GTK_SPIN_BUTTON (entry));
-      g_print ("%.*f\n", prec, gtk_spin_button_get_value (GTK_SPIN_BUTTON (entry)));
+      yad_output_double (gtk_spin_button_get_value (GTK_SPIN_BUTTON (entry)), prec, FALSE);
     }
   else if (is_combo)
     {
       if (options.common_data.num_output)
-        g_print ("%d\n", gtk_combo_box_get_active (GTK_COMBO_BOX (entry)) + 1);
+        yad_output_int (gtk_combo_box_get_active (GTK_COMBO_BOX (entry)) + 1, FALSE);
       else
-        g_print ("%s\n", gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (entry)));
+        {
+          gchar *txt = gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (entry));
+          yad_output_plain (txt);
+          g_free (txt);
+        }
     }
   else
-    g_print ("%s\n", gtk_entry_get_text (GTK_ENTRY (entry)));
+    yad_output_plain (gtk_entry_get_text (GTK_ENTRY (entry)));
+  yad_output_row_end (FALSE);
 }
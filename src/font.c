@@ -67,36 +67,15 @@ font_print_result (void)
       family = gtk_font_chooser_get_font_family (GTK_FONT_CHOOSER (font));
       size = gtk_font_chooser_get_font_size (GTK_FONT_CHOOSER (font));
 
-      if (options.common_data.quoted_output)
-        {
-          gchar *q1 = g_shell_quote (pango_font_family_get_name (family));
-          gchar *q2 = g_shell_quote (pango_font_face_get_face_name (face));
-
-          g_printf ("%s%s%s%s%d\n", q1, options.common_data.separator, q2,
-                    options.common_data.separator, size / PANGO_SCALE);
-
-          g_free (q1);
-          g_free (q2);
-        }
-      else
-        {
-          g_printf ("%s%s%s%s%d\n", pango_font_family_get_name (family), options.common_data.separator,
-                    pango_font_face_get_face_name (face), options.common_data.separator, size / PANGO_SCALE);
-        }
+      yad_output_string (pango_font_family_get_name (family));
+      yad_output_string (pango_font_face_get_face_name (face));
+      yad_output_int (size / PANGO_SCALE, FALSE);
     }
   else
     {
       gchar *fn = gtk_font_chooser_get_font (GTK_FONT_CHOOSER (font));
-
-      if (options.common_data.quoted_output)
-        {
-          gchar *buf = g_shell_quote (fn);
-          g_printf ("%s\n", buf);
-          g_free (buf);
-        }
-      else
-        g_printf ("%s\n", fn);
-
+      yad_output_string (fn);
       g_free (fn);
     }
+  yad_output_row_end (FALSE);
 }
@@ -28,6 +28,8 @@ static GSList *fields = NULL;
 static guint n_fields;
 
 static gboolean disable_changed = TRUE;
+/* values from framed input are not escaped */
+static gboolean raw_value = FALSE;
 
 /* expand %N in command to fields values */
 static GString *
@@ -371,7 +373,7 @@ set_field_value (guint num, gchar *value)
       {
         GtkTextIter iter;
         GtkTextBuffer *tb = gtk_text_view_get_buffer (GTK_TEXT_VIEW (w));
-        gchar *txt = g_strcompress (value);
+        gchar *txt = raw_value ? g_strdup (value) : g_strcompress (value);
         gtk_text_buffer_set_text (tb, "", -1);
         gtk_text_buffer_get_start_iter (tb, &iter);
         if (options.data.no_markup)
@@ -741,80 +743,58 @@ set_icon_cb (GtkEntry *e, gpointer d)
     gtk_entry_set_icon_from_icon_name (e, GTK_ENTRY_ICON_PRIMARY, icon);
 }
 
-static gboolean
-handle_stdin (GIOChannel * ch, GIOCondition cond, gpointer data)
-{
-  static guint cnt = 0;
+static guint stdin_cnt = 0;
 
-  if ((cond == G_IO_IN) || (cond == G_IO_IN + G_IO_HUP))
+static void
+parse_line (gchar *str)
+{
+  if (str[0])
     {
-      GError *err = NULL;
-      GString *string = g_string_new (NULL);
-
-      while (ch->is_readable != TRUE);
-
-      do
+      if (str[0] == '\014')
         {
-          gint status;
-
-          if (cnt == n_fields)
-            {
-              if (options.form_data.cycle_read)
-                cnt = 0;
-              else
-                goto shutdown;
-            }
-
-          do
-            {
-              status = g_io_channel_read_line_string (ch, string, NULL, &err);
-
-              while (gtk_events_pending ())
-                gtk_main_iteration ();
-            }
-          while (status == G_IO_STATUS_AGAIN);
-
-          if (status != G_IO_STATUS_NORMAL)
-            {
-              if (err)
-                {
-                  g_printerr ("yad_form_handle_stdin(): %s\n", err->message);
-                  g_error_free (err);
-                  err = NULL;
-                }
-              /* stop handling */
-              goto shutdown;
-            }
-
-          strip_new_line (string->str);
-          if (string->str[0])
-            {
-              if (string->str[0] == '\014')
-                {
-                  gint i;
-                  /* clear the form and reset fields counter */
-                  for (i = 0; i < n_fields; i++)
-                    set_field_value (i, "");
-                  cnt = -1; /* must be -1 due to next increment */
-                }
-              else
-                set_field_value (cnt, string->str);
-            }
-          cnt++;
+          gint i;
+          /* clear the form and reset fields counter */
+          for (i = 0; i < n_fields; i++)
+            set_field_value (i, "");
+          stdin_cnt = -1; /* must be -1 due to next increment */
         }
-      while (g_io_channel_get_buffer_condition (ch) == G_IO_IN);
-      g_string_free (string, TRUE);
+      else
+        set_field_value (stdin_cnt, str);
+    }
+  stdin_cnt++;
+}
+
+static gboolean
+next_field ()
+{
+  if (stdin_cnt == n_fields)
+    {
+      if (options.form_data.cycle_read)
+        stdin_cnt = 0;
+      else
+        return FALSE;
     }
+  return TRUE;
+}
+
+static gboolean
+stdin_record_cb (gchar *str, gsize len, gpointer data)
+{
+  if (!next_field ())
+    return FALSE;
 
-  if ((cond != G_IO_IN) && (cond != G_IO_IN + G_IO_HUP))
-    goto shutdown;
+  /* values in lines format are escaped */
+  raw_value = (options.common_data.input_fmt != YAD_INPUT_LINES);
+  parse_line (str);
+  raw_value = FALSE;
 
   return TRUE;
+}
 
- shutdown:
-  g_io_channel_shutdown (ch, TRUE, NULL);
+static void
+stdin_done (gpointer data)
+{
   disable_changed = FALSE;
-  return FALSE;
 }
 
 GtkWidget *
@@ -1364,13 +1344,18 @@ form_create_widget (GtkWidget * dlg)
               i++;
             }
         }
-      else
+      else if (yad_rest_count () > 0)
         {
-          GIOChannel *channel = g_io_channel_unix_new (0);
-          g_io_channel_set_encoding (channel, NULL, NULL);
-          g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
-          g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, NULL);
+          for (i = 0; i < n_fields && i < yad_rest_count (); i++)
+            {
+              gchar *val = yad_rest_get (i);
+              set_field_value (i, val);
+              g_free (val);
+            }
+          yad_rest_close ();
         }
+      else
+        yad_read_records (0, stdin_record_cb, stdin_done, NULL);
     }
 
   if (options.form_data.focus_field > 0 && options.form_data.focus_field <= n_fields)
@@ -1399,159 +1384,75 @@ form_print_field (guint fn)
     case YAD_FIELD_DIR_CREATE:
     case YAD_FIELD_DATE:
     case YAD_FIELD_ICON:
-      if (options.common_data.quoted_output)
-        {
-          buf = g_shell_quote (gtk_entry_get_text (GTK_ENTRY (g_slist_nth_data (fields, fn))));
-          g_printf ("%s%s", buf, options.common_data.separator);
-          g_free (buf);
-        }
-      else
-        g_printf ("%s%s", gtk_entry_get_text (GTK_ENTRY (g_slist_nth_data (fields, fn))),
-                  options.common_data.separator);
+      yad_output_string (gtk_entry_get_text (GTK_ENTRY (g_slist_nth_data (fields, fn))));
       break;
     case YAD_FIELD_NUM:
       {
         guint prec = gtk_spin_button_get_digits (GTK_SPIN_BUTTON (g_slist_nth_data (fields, fn)));
-        if (options.common_data.quoted_output)
-          g_printf ("'%.*f'%s", prec, gtk_spin_button_get_value (GTK_SPIN_BUTTON (g_slist_nth_data (fields, fn))),
-                    options.common_data.separator);
-        else
-          g_printf ("%.*f%s", prec, gtk_spin_button_get_value (GTK_SPIN_BUTTON (g_slist_nth_data (fields, fn))),
-                    options.common_data.separator);
+        yad_output_double (gtk_spin_button_get_value (GTK_SPIN_BUTTON (g_slist_nth_data (fields, fn))), prec, TRUE);
         break;
       }
     case YAD_FIELD_CHECK:
-      if (options.common_data.quoted_output)
-        g_printf ("'%s'%s", print_bool_val (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (g_slist_nth_data (fields, fn)))),
-                  options.common_data.separator);
-      else
-        g_printf ("%s%s", print_bool_val (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (g_slist_nth_data (fields, fn)))),
-                  options.common_data.separator);
+      yad_output_bool (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (g_slist_nth_data (fields, fn))));
       break;
     case YAD_FIELD_SWITCH:
-      if (options.common_data.quoted_output)
-        g_printf ("'%s'%s", print_bool_val (gtk_switch_get_state (GTK_SWITCH (g_slist_nth_data (fields, fn)))),
-                  options.common_data.separator);
-      else
-        g_printf ("%s%s", print_bool_val (gtk_switch_get_state (GTK_SWITCH (g_slist_nth_data (fields, fn)))),
-                  options.common_data.separator);
+      yad_output_bool (gtk_switch_get_state (GTK_SWITCH (g_slist_nth_data (fields, fn))));
       break;
     case YAD_FIELD_COMBO:
     case YAD_FIELD_COMBO_ENTRY:
       if (options.common_data.num_output && fld->type == YAD_FIELD_COMBO)
-        g_printf ("%d%s", gtk_combo_box_get_active (GTK_COMBO_BOX (g_slist_nth_data (fields, fn))) + 1,
-                  options.common_data.separator);
-      else if (options.common_data.quoted_output)
+        yad_output_int (gtk_combo_box_get_active (GTK_COMBO_BOX (g_slist_nth_data (fields, fn))) + 1, FALSE);
+      else
         {
-          buf = g_shell_quote (gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (g_slist_nth_data (fields, fn))));
-          g_printf ("%s%s", buf, options.common_data.separator);
+          buf = gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (g_slist_nth_data (fields, fn)));
+          yad_output_string (buf);
           g_free (buf);
         }
-      else
-        g_printf ("%s%s", gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (g_slist_nth_data (fields, fn))),
-                  options.common_data.separator);
       break;
     case YAD_FIELD_FILE:
     case YAD_FIELD_DIR:
-      if (options.common_data.quoted_output)
-        {
-          gchar *fname = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (g_slist_nth_data (fields, fn)));
-          buf = g_shell_quote (fname ? fname : "");
-          g_free (fname);
-          g_printf ("%s%s", buf ? buf : "", options.common_data.separator);
-          g_free (buf);
-        }
-      else
-        {
-          buf = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (g_slist_nth_data (fields, fn)));
-          g_printf ("%s%s", buf ? buf : "", options.common_data.separator);
-          g_free (buf);
-        }
+      buf = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (g_slist_nth_data (fields, fn)));
+      yad_output_string (buf);
+      g_free (buf);
       break;
     case YAD_FIELD_FONT:
-      {
-        gchar *fname = gtk_font_chooser_get_font (GTK_FONT_CHOOSER (g_slist_nth_data (fields, fn)));
-        if (options.common_data.quoted_output)
-          g_printf ("'%s'%s", fname ? fname : "", options.common_data.separator);
-        else
-          g_printf ("%s%s", fname ? fname : "", options.common_data.separator);
-        g_free (fname);
-        break;
-      }
+      buf = gtk_font_chooser_get_font (GTK_FONT_CHOOSER (g_slist_nth_data (fields, fn)));
+      yad_output_string (buf);
+      g_free (buf);
+      break;
     case YAD_FIELD_APP:
       {
-        gchar *exec;
         GAppInfo *info = NULL;
         GList *wl = gtk_container_get_children (GTK_CONTAINER (g_slist_nth_data (fields, fn)));
 
         if (wl)
-          {
-            info = gtk_app_chooser_get_app_info (GTK_APP_CHOOSER (wl->data));
-            if (info)
-              exec = (gchar *) g_app_info_get_executable (info);
-            else
-              exec = "";
-          }
-        else
-          exec = "";
+          info = gtk_app_chooser_get_app_info (GTK_APP_CHOOSER (wl->data));
 
-        if (options.common_data.quoted_output)
-          {
-            buf = g_shell_quote (exec);
-            g_printf ("%s%s", buf, options.common_data.separator);
-            g_free (buf);
-          }
-        else
-          g_printf ("%s%s", exec, options.common_data.separator);
+        yad_output_string (info ? g_app_info_get_executable (info) : "");
         if (info)
           g_object_unref (info);
         break;
       }
     case YAD_FIELD_COLOR:
       {
-        gchar *cs;
         GdkRGBA c;
         GtkColorChooser *cb = GTK_COLOR_CHOOSER (g_slist_nth_data (fields, fn));
         gtk_color_chooser_get_rgba (cb, &c);
-        cs = get_color (&c);
-
-        if (options.common_data.quoted_output)
-          {
-            buf = g_shell_quote (cs ? cs : "");
-            g_printf ("%s%s", buf, options.common_data.separator);
-            g_free (buf);
-          }
-        else
-          g_printf ("%s%s", cs, options.common_data.separator);
-        g_free (cs);
+        buf = get_color (&c);
+        yad_output_string (buf);
+        g_free (buf);
         break;
       }
     case YAD_FIELD_SCALE:
-      if (options.common_data.quoted_output)
-        g_printf ("'%d'%s", (gint) gtk_range_get_value (GTK_RANGE (g_slist_nth_data (fields, fn))),
-                  options.common_data.separator);
-      else
-        g_printf ("%d%s", (gint) gtk_range_get_value (GTK_RANGE (g_slist_nth_data (fields, fn))),
-                  options.common_data.separator);
+      yad_output_int ((gint) gtk_range_get_value (GTK_RANGE (g_slist_nth_data (fields, fn))), TRUE);
       break;
     case YAD_FIELD_LINK:
-      if (options.common_data.quoted_output)
-        {
-          buf = g_shell_quote (gtk_link_button_get_uri (GTK_LINK_BUTTON (g_slist_nth_data (fields, fn))));
-          g_printf ("%s%s", buf, options.common_data.separator);
-          g_free (buf);
-        }
-      else
-        g_printf ("%s%s", gtk_link_button_get_uri (GTK_LINK_BUTTON (g_slist_nth_data (fields, fn))),
-                  options.common_data.separator);
+      yad_output_string (gtk_link_button_get_uri (GTK_LINK_BUTTON (g_slist_nth_data (fields, fn))));
       break;
     case YAD_FIELD_BUTTON:
     case YAD_FIELD_FULL_BUTTON:
     case YAD_FIELD_LABEL:
-      if (options.common_data.quoted_output)
-        g_printf ("''%s", options.common_data.separator);
-      else
-        g_printf ("%s", options.common_data.separator);
+      yad_output_string ("");
       break;
     case YAD_FIELD_TEXT:
       {
@@ -1561,16 +1462,15 @@ form_print_field (guint fn)
 
         tb = gtk_text_view_get_buffer (GTK_TEXT_VIEW (g_slist_nth_data (fields, fn)));
         gtk_text_buffer_get_bounds (tb, &b, &e);
-        txt = escape_str (gtk_text_buffer_get_text (tb, &b, &e, FALSE));
-        if (options.common_data.quoted_output)
-          {
-            buf = g_shell_quote (txt);
-            g_printf ("%s%s", buf, options.common_data.separator);
-            g_free (buf);
-          }
+        buf = gtk_text_buffer_get_text (tb, &b, &e, FALSE);
+        /* only shell format needs escaped line breaks */
+        if (options.common_data.output_fmt != YAD_OUTPUT_SHELL)
+          txt = g_strdup (buf);
         else
-          g_printf ("%s%s", txt, options.common_data.separator);
+          txt = escape_str (buf);
+        yad_output_string (txt);
         g_free (txt);
+        g_free (buf);
       }
     }
 }
@@ -1601,5 +1501,5 @@ form_print_result (void)
       for (i = 0; i < n_fields; i++)
         form_print_field (i);
     }
-  g_printf ("\n");
+  yad_output_row_end (TRUE);
 }
@@ -159,7 +159,11 @@ policy_cb (WebKitWebView *v, WebKitPolicyDecision *pd, WebKitPolicyDecisionType
             {
               webkit_policy_decision_ignore (pd);
               if (options.html_data.print_uri)
-                g_printf ("%s\n", uri);
+                {
+                  yad_output_plain (uri);
+                  yad_output_row_end (FALSE);
+                  yad_output_flush ();
+                }
               else
                 g_app_info_launch_default_for_uri (uri, NULL, NULL);
             }
@@ -627,7 +631,7 @@ html_create_widget (GtkWidget * dlg)
   /* create search bar */
   if (options.common_data.enable_search)
     {
-      if ((search_bar = create_search_bar ()) != NULL)
+      if ((search_bar = create_search_bar (FALSE)) != NULL)
         {
           gtk_box_pack_start (GTK_BOX (w), search_bar->bar, FALSE, FALSE, 0);
           g_signal_connect (G_OBJECT (search_bar->entry), "search-changed", G_CALLBACK (search_changed_cb), NULL);
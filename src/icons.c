@@ -72,6 +72,33 @@ scale_pixbuf (GdkPixbuf *pb)
   return res;
 }
 
+static GdkPixbuf *
+get_icon_pixbuf (gchar *name)
+{
+  GdkPixbuf *pb, *spb = NULL;
+  gchar *key;
+
+  if (options.icons_data.compact)
+    return get_pixbuf (name, YAD_SMALL_ICON, TRUE);
+
+  /* scaled icons are cached too, so each one is scaled only once */
+  key = g_strdup_printf ("icons:%d:%s", options.common_data.icon_size, name);
+  spb = pixbuf_cache_lookup (key);
+  if (spb == NULL)
+    {
+      pb = get_pixbuf (name, YAD_BIG_ICON, FALSE);
+      if (pb)
+        {
+          spb = scale_pixbuf (pb);
+          g_object_unref (pb);
+          pixbuf_cache_insert (key, spb);
+        }
+    }
+  g_free (key);
+
+  return spb;
+}
+
 static void
 select_cb (GObject * obj, gpointer data)
 {
@@ -143,13 +170,14 @@ activate_cb (GtkWidget * view, GtkTreePath * path, gpointer data)
     }
 }
 
-static gboolean
-handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
+static void
+parse_line (gchar *str)
 {
   static GtkTreeIter iter;
   static gint column_count = 1;
   static gboolean first_time = TRUE;
   GtkTreeModel *model;
+  GdkPixbuf *spb = NULL;
 
   if (!options.icons_data.compact)
     model = gtk_icon_view_get_model (GTK_ICON_VIEW (icon_view));
@@ -163,6 +191,60 @@ handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
       gtk_list_store_set (GTK_LIST_STORE (model), &iter, COL_FILENAME, "", -1);
     }
 
+  /* clear list if ^L received */
+  if (str[0] == '\014')
+    {
+      gtk_list_store_clear (GTK_LIST_STORE (model));
+      column_count = 1;
+      return;
+    }
+
+  if (column_count == NUM_COLS)
+    {
+      /* We're starting a new row */
+      column_count = 1;
+      gtk_list_store_append (GTK_LIST_STORE (model), &iter);
+      gtk_list_store_set (GTK_LIST_STORE (model), &iter, COL_FILENAME, "", -1);
+    }
+
+  switch (column_count)
+    {
+    case COL_NAME:
+    case COL_COMMAND:
+      gtk_list_store_set (GTK_LIST_STORE (model), &iter, column_count, str, -1);
+      break;
+    case COL_TOOLTIP:
+      {
+        gchar *buf = g_markup_escape_text (str, -1);
+        gtk_list_store_set (GTK_LIST_STORE (model), &iter, column_count, buf, -1);
+        g_free (buf);
+        break;
+      }
+    case COL_PIXBUF:
+      if (!options.icons_data.compact || *str)
+        spb = get_icon_pixbuf (str);
+      gtk_list_store_set (GTK_LIST_STORE (model), &iter, column_count, spb, -1);
+      if (spb)
+        g_object_unref (spb);
+      break;
+    case COL_TERM:
+      gtk_list_store_set (GTK_LIST_STORE (model), &iter, column_count, get_bool_val (str), -1);
+      break;
+    }
+
+  column_count++;
+}
+
+static gboolean
+stdin_record_cb (gchar *str, gsize len, gpointer data)
+{
+  parse_line (str);
+  return TRUE;
+}
+
+static gboolean
+handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
+{
   if ((condition == G_IO_IN) || (condition == G_IO_IN + G_IO_HUP))
     {
       GError *err = NULL;
@@ -173,7 +255,6 @@ handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
 
       do
         {
-          GdkPixbuf *spb = NULL;
           gint status;
 
           do
@@ -199,60 +280,7 @@ handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
               return FALSE;
             }
 
-          /* clear list if ^L received */
-          if (string->str[0] == '\014')
-            {
-              gtk_list_store_clear (GTK_LIST_STORE (model));
-              column_count = 1;
-              continue;
-            }
-
-          if (column_count == NUM_COLS)
-            {
-              /* We're starting a new row */
-              column_count = 1;
-              gtk_list_store_append (GTK_LIST_STORE (model), &iter);
-              gtk_list_store_set (GTK_LIST_STORE (model), &iter, COL_FILENAME, "", -1);
-            }
-
-          switch (column_count)
-            {
-            case COL_NAME:
-            case COL_COMMAND:
-              gtk_list_store_set (GTK_LIST_STORE (model), &iter, column_count, string->str, -1);
-              break;
-            case COL_TOOLTIP:
-              {
-                gchar *buf = g_markup_escape_text (string->str, -1);
-                gtk_list_store_set (GTK_LIST_STORE (model), &iter, column_count, buf, -1);
-                g_free (buf);
-                break;
-              }
-            case COL_PIXBUF:
-              if (options.icons_data.compact)
-                {
-                  if (*string->str)
-                    spb = get_pixbuf (string->str, YAD_SMALL_ICON, TRUE);
-                }
-              else
-                {
-                  GdkPixbuf *pb = get_pixbuf (string->str, YAD_BIG_ICON, FALSE);
-                  if (pb)
-                    {
-                      spb = scale_pixbuf (pb);
-                      g_object_unref (pb);
-                    }
-                }
-              gtk_list_store_set (GTK_LIST_STORE (model), &iter, column_count, spb, -1);
-              if (spb)
-                g_object_unref (spb);
-              break;
-            case COL_TERM:
-              gtk_list_store_set (GTK_LIST_STORE (model), &iter, column_count, get_bool_val (string->str), -1);
-              break;
-            }
-
-          column_count++;
+          parse_line (string->str);
         }
       while (g_io_channel_get_buffer_condition (channel) == G_IO_IN);
       g_string_free (string, TRUE);
@@ -353,15 +381,7 @@ parse_desktop_file (gchar * filename)
           icon = g_key_file_get_string (kf, "Desktop Entry", "Icon", NULL);
           if (icon)
             {
-              if (options.icons_data.compact)
-                ent->pixbuf = get_pixbuf (icon, YAD_SMALL_ICON, TRUE);
-              else
-                {
-                  GdkPixbuf *pb = get_pixbuf (icon, YAD_BIG_ICON, FALSE);
-                  ent->pixbuf = scale_pixbuf (pb);
-                  if (pb)
-                    g_object_unref (pb);
-                }
+              ent->pixbuf = get_icon_pixbuf (icon);
               g_free (icon);
             }
         }
@@ -493,6 +513,8 @@ icons_create_widget (GtkWidget * dlg)
   /* handle directory */
   if (options.icons_data.directory)
     read_dir ();
+  else if (options.common_data.listen && options.common_data.input_fmt != YAD_INPUT_LINES)
+    yad_read_records (0, stdin_record_cb, NULL, NULL);
   else if (options.common_data.listen)
     {
       /* read from stdin */
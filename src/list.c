@@ -19,12 +19,69 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <signal.h>
 
 #include "yad.h"
+#include "listmodel.h"
+
+/* maximum time (in microseconds) spent for inserting rows in one main loop iteration */
+#define LIST_FRAME_BUDGET 8000
+/* detach model from view if more than this number of rows are waiting for insertion */
+#define LIST_DETACH_ROWS 1000
+/* number of rows used for estimating column widths in fixed layout */
+#define LIST_SAMPLE_ROWS 100
+
+typedef enum {
+  LIST_ROW_ADD = 0,
+  LIST_ROW_DEL,
+  LIST_ROW_SET,
+  /* end of lazy loaded children of the node */
+  LIST_ROW_LOADED
+} YadListOp;
+
+/* row parsed from input but not inserted to the model yet */
+typedef struct {
+  YadListOp op;
+  gchar *id;
+  gchar *pid;
+  /* key and column for control operations */
+  gchar *key;
+  guint col;
+  gchar **data;
+  guint n_data;
+} YadListRow;
+
+/* compiled column descriptor */
+typedef struct {
+  YadColumn *col;
+  GType gtype;
+  /* renderer attribute for model column */
+  const gchar *attr;
+  /* convert input string to the value. returns FALSE if value is not set */
+  gboolean (*parse) (gchar *data, GValue *val);
+  /* get value as a string for commands arguments */
+  gchar *(*format) (GtkTreeModel *model, GtkTreeIter *it, gint num);
+  /* print value. NULL for non-printable columns */
+  void (*print) (GtkTreeModel *model, GtkTreeIter *it, gint num);
+} YadListCol;
 
 static GtkWidget *list_view;
+static GtkTreeModel *list_model;
+static YadListCol *schema = NULL;
 
+/* tree index. iterators of tree store are persistent, so row id is mapped directly to the node.
+   node_ids maps node back to its id for cleanup on removing */
 static GHashTable *row_hash = NULL;
+static GHashTable *node_ids = NULL;
+/* rows which parent is not added yet, by parent id */
+static GHashTable *orphans = NULL;
+/* lazy tree loading. nodes which are not loaded yet have a placeholder child.
+   lazy_nodes maps node to its placeholder, lazy_loading contains ids of nodes being loaded */
+static GHashTable *lazy_nodes = NULL;
+static GHashTable *lazy_loading = NULL;
+/* index of rows by key column value */
+static GHashTable *key_hash = NULL;
+static gint key_col = -1;
 
 static gint fore_col, back_col, font_col;
 static guint n_cols = 0;
@@ -34,32 +91,87 @@ static gulong select_hndl = 0;
 static gchar *column_align = NULL;
 static gchar *header_align = NULL;
 
-static inline void
-yad_list_add_row (GtkTreeStore *m, GtkTreeIter *it, gchar *row_id, gchar *par_id)
+static gboolean widths_done = FALSE;
+
+/* bulk loading */
+static GQueue *pending_rows = NULL;
+static YadListRow *cur_row = NULL;
+static guint flush_id = 0;
+static guint n_top_rows = 0;
+static gboolean detached = FALSE;
+static gboolean load_done = FALSE;
+static gulong loaded_rows = 0;
+static gint64 load_start = 0;
+/* last added row for autoscroll */
+static GtkTreeRowReference *tail_ref = NULL;
+static guint tail_tick = 0;
+
+/* live filter. visibility of the rows is kept in bitmap indexed by row id */
+#define FILTER_GET(m,id) ((m)[(id) >> 5] & (1U << ((id) & 31)))
+
+typedef struct {
+  GRegex *re;
+  GArray *ids;
+  GArray *offs;
+  GString *text;
+  guint n_ids;
+  guint32 *map;
+} YadFilterScan;
+
+static GtkTreeModel *filter_model = NULL;
+static gint filter_col = -1;
+static GRegex *filter_re = NULL;
+static gchar *filter_text = NULL;
+static guint32 *filter_map = NULL;
+static guint filter_size = 0;
+static GCancellable *filter_cancel = NULL;
+/* rows changed while scan is running */
+static GHashTable *filter_dirty = NULL;
+static gboolean filter_complete = FALSE;
+
+static YadListRow *
+list_row_new ()
 {
-  GtkTreePath *row_path;
-  GtkTreeIter pit, *parent = NULL;
+  YadListRow *row = g_new0 (YadListRow, 1);
+  row->data = g_new0 (gchar *, n_cols + 1);
+  return row;
+}
 
-  if (par_id && par_id[0])
-    {
-      GtkTreePath *par_path = g_hash_table_lookup (row_hash, par_id);
-      if (par_path)
-        {
-          if (gtk_tree_model_get_iter (GTK_TREE_MODEL (m), &pit, par_path))
-            parent = &pit;
-        }
-    }
+static void
+list_row_free (YadListRow *row)
+{
+  if (row == NULL)
+    return;
+  g_free (row->id);
+  g_free (row->pid);
+  g_free (row->key);
+  g_strfreev (row->data);
+  g_free (row);
+}
+
+/* set values in the model regardless of its type */
+static void
+list_set (GtkTreeIter *it, ...)
+{
+  va_list args;
 
-  if (options.list_data.add_on_top)
-    gtk_tree_store_prepend (m, it, parent);
+  va_start (args, it);
+  if (YAD_IS_LIST_MODEL (list_model))
+    yad_list_model_set_valist (YAD_LIST_MODEL (list_model), it, args);
   else
-    gtk_tree_store_append (m, it, parent);
+    gtk_tree_store_set_valist (GTK_TREE_STORE (list_model), it, args);
+  va_end (args);
+}
 
-  row_path = gtk_tree_model_get_path (GTK_TREE_MODEL (m), it);
-  if (row_id && row_id[0])
-    g_hash_table_insert (row_hash, row_id, row_path);
-  if (options.common_data.tail)
-    gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (list_view), row_path, NULL, FALSE, 1.0, 1.0);
+/* convert iterator of the view model to the list model one */
+static void
+view_to_list_iter (GtkTreeIter *it)
+{
+  if (filter_model)
+    {
+      GtkTreeIter vit = *it;
+      gtk_tree_model_filter_convert_iter_to_child_iter (GTK_TREE_MODEL_FILTER (filter_model), it, &vit);
+    }
 }
 
 static gboolean
@@ -132,7 +244,8 @@ toggled_cb (GtkCellRendererToggle *cell, gchar *path_str, gpointer data)
 
   fixed ^= 1;
 
-  gtk_tree_store_set (GTK_TREE_STORE (model), &iter, column, fixed, -1);
+  view_to_list_iter (&iter);
+  list_set (&iter, column, fixed, -1);
 
   gtk_tree_path_free (path);
 }
@@ -141,7 +254,7 @@ static gboolean
 runtoggle (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer data)
 {
   gint col = GPOINTER_TO_INT (data);
-  gtk_tree_store_set (GTK_TREE_STORE (model), iter, col, FALSE, -1);
+  list_set (iter, col, FALSE, -1);
   return FALSE;
 }
 
@@ -155,10 +268,12 @@ rtoggled_cb (GtkCellRendererToggle *cell, gchar *path_str, gpointer data)
 
   column = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (cell), "column"));
 
-  gtk_tree_model_foreach (model, runtoggle, GINT_TO_POINTER (column));
+  /* reset hidden rows too */
+  gtk_tree_model_foreach (list_model, runtoggle, GINT_TO_POINTER (column));
 
   gtk_tree_model_get_iter (model, &iter, path);
-  gtk_tree_store_set (GTK_TREE_STORE (model), &iter, column, TRUE, -1);
+  view_to_list_iter (&iter);
+  list_set (&iter, column, TRUE, -1);
 
   gtk_tree_path_free (path);
 }
@@ -174,7 +289,7 @@ cell_edited_cb (GtkCellRendererText *cell, const gchar *path_string, const gchar
 
   column = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (cell), "column"));
   gtk_tree_model_get_iter (model, &iter, path);
-  col = (YadColumn *) g_slist_nth_data (options.list_data.columns, column);
+  col = schema[column].col;
 
   if (col->type == YAD_COLUMN_NUM)
     gtk_tree_store_set (GTK_TREE_STORE (model), &iter, column, g_ascii_strtoll (new_text, NULL, 10), -1);
@@ -218,11 +333,253 @@ regex_search (GtkTreeModel *model, gint col, const gchar *key, GtkTreeIter *iter
     return TRUE;
 }
 
+/* cells access regardless of model type */
+static gboolean
+get_bool_cell (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  gboolean val;
+
+  if (YAD_IS_LIST_MODEL (model))
+    return yad_list_model_get_boolean (YAD_LIST_MODEL (model), it, num);
+  gtk_tree_model_get (model, it, num, &val, -1);
+  return val;
+}
+
+static gint64
+get_int_cell (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  gint64 val;
+
+  if (YAD_IS_LIST_MODEL (model))
+    return yad_list_model_get_int64 (YAD_LIST_MODEL (model), it, num);
+  gtk_tree_model_get (model, it, num, &val, -1);
+  return val;
+}
+
+static gdouble
+get_float_cell (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  gdouble val;
+
+  if (YAD_IS_LIST_MODEL (model))
+    return yad_list_model_get_double (YAD_LIST_MODEL (model), it, num);
+  gtk_tree_model_get (model, it, num, &val, -1);
+  return val;
+}
+
+/* returns string which must be freed with g_free. for the flat model string isn't copied */
+static const gchar *
+get_text_cell (GtkTreeModel *model, GtkTreeIter *it, gint num, gchar **tmp)
+{
+  *tmp = NULL;
+  if (YAD_IS_LIST_MODEL (model))
+    return yad_list_model_get_string (YAD_LIST_MODEL (model), it, num);
+  gtk_tree_model_get (model, it, num, tmp, -1);
+  return *tmp;
+}
+
+/* parsers. convert input string to the value of column type. return FALSE if value is not set */
+static gboolean
+parse_bool (gchar *data, GValue *val)
+{
+  g_value_init (val, G_TYPE_BOOLEAN);
+  g_value_set_boolean (val, get_bool_val (data));
+  return TRUE;
+}
+
+static gboolean
+parse_int (gchar *data, GValue *val)
+{
+  g_value_init (val, G_TYPE_INT64);
+  g_value_set_int64 (val, g_ascii_strtoll (data, NULL, 10));
+  return TRUE;
+}
+
+static gboolean
+parse_float (gchar *data, GValue *val)
+{
+  g_value_init (val, G_TYPE_DOUBLE);
+  g_value_set_double (val, g_ascii_strtod (data, NULL));
+  return TRUE;
+}
+
+static gboolean
+parse_bar (gchar *data, GValue *val)
+{
+  gint64 v = g_ascii_strtoll (data, NULL, 10);
+
+  g_value_init (val, G_TYPE_INT64);
+  g_value_set_int64 (val, CLAMP (v, 0, 100));
+  return TRUE;
+}
+
+static gboolean
+parse_image (gchar *data, GValue *val)
+{
+  GdkPixbuf *pb = get_image_pixbuf (data, YAD_SMALL_ICON);
+
+  if (!pb)
+    return FALSE;
+
+  g_value_init (val, GDK_TYPE_PIXBUF);
+  g_value_take_object (val, pb);
+  return TRUE;
+}
+
+static gboolean
+parse_text (gchar *data, GValue *val)
+{
+  if (!data || !*data)
+    return FALSE;
+
+  /* model makes its own copy */
+  g_value_init (val, G_TYPE_STRING);
+  g_value_set_static_string (val, data);
+  return TRUE;
+}
+
+/* formatters. return cell value as a string for command arguments */
+static gchar *
+format_bool (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  return g_strdup (print_bool_val (get_bool_cell (model, it, num)));
+}
+
+static gchar *
+format_int (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  return g_strdup_printf ("%ld", (long) get_int_cell (model, it, num));
+}
+
+static gchar *
+format_float (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  return g_strdup_printf ("%lf", get_float_cell (model, it, num));
+}
+
+static gchar *
+format_image (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  return g_strdup ("''");
+}
+
+static gchar *
+format_text (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  gchar *tmp, *res = NULL;
+  const gchar *val = get_text_cell (model, it, num, &tmp);
+
+  if (val)
+    res = g_shell_quote (val);
+  g_free (tmp);
+
+  return res;
+}
+
+/* printers. output cell value in the dialog result */
+static void
+print_bool (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  yad_output_bool (get_bool_cell (model, it, num));
+}
+
+static void
+print_int (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  yad_output_int (get_int_cell (model, it, num), TRUE);
+}
+
+static void
+print_float (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  yad_output_double (get_float_cell (model, it, num), options.common_data.float_precision, TRUE);
+}
+
+static void
+print_image (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  yad_output_string ("");
+}
+
+static void
+print_text (GtkTreeModel *model, GtkTreeIter *it, gint num)
+{
+  gchar *tmp;
+
+  yad_output_string (get_text_cell (model, it, num, &tmp));
+  g_free (tmp);
+}
+
+/* fill column descriptor according to its type */
+static void
+compile_column (YadListCol *sc, YadColumn *col)
+{
+  sc->col = col;
+
+  switch (col->type)
+    {
+    case YAD_COLUMN_CHECK:
+    case YAD_COLUMN_RADIO:
+      sc->gtype = G_TYPE_BOOLEAN;
+      sc->attr = "active";
+      sc->parse = parse_bool;
+      sc->format = format_bool;
+      sc->print = print_bool;
+      break;
+    case YAD_COLUMN_NUM:
+    case YAD_COLUMN_SIZE:
+      sc->gtype = G_TYPE_INT64;
+      sc->attr = "text";
+      sc->parse = parse_int;
+      sc->format = format_int;
+      sc->print = print_int;
+      break;
+    case YAD_COLUMN_BAR:
+      sc->gtype = G_TYPE_INT64;
+      sc->attr = "value";
+      sc->parse = parse_bar;
+      sc->format = format_int;
+      sc->print = print_int;
+      break;
+    case YAD_COLUMN_FLOAT:
+      sc->gtype = G_TYPE_DOUBLE;
+      sc->attr = "text";
+      sc->parse = parse_float;
+      sc->format = format_float;
+      sc->print = print_float;
+      break;
+    case YAD_COLUMN_IMAGE:
+      sc->gtype = GDK_TYPE_PIXBUF;
+      sc->attr = "pixbuf";
+      sc->parse = parse_image;
+      sc->format = format_image;
+      sc->print = print_image;
+      break;
+    case YAD_COLUMN_ATTR_FORE:
+    case YAD_COLUMN_ATTR_BACK:
+    case YAD_COLUMN_ATTR_FONT:
+      /* attributes are not printed */
+      sc->gtype = G_TYPE_STRING;
+      sc->parse = parse_text;
+      sc->format = format_text;
+      sc->print = NULL;
+      break;
+    default:
+      sc->gtype = G_TYPE_STRING;
+      sc->attr = options.data.no_markup ? "text" : "markup";
+      sc->parse = parse_text;
+      sc->format = format_text;
+      sc->print = print_text;
+      break;
+    }
+}
+
 static GtkTreeModel *
 create_model ()
 {
-  GtkTreeStore *store;
+  GtkTreeModel *model;
   GType *ctypes;
+  GSList *c;
   gint i;
 
   ctypes = g_new0 (GType, n_cols);
@@ -238,48 +595,32 @@ create_model ()
       col->type = YAD_COLUMN_RADIO;
     }
 
-  for (i = 0; i < n_cols; i++)
+  /* compile columns schema */
+  schema = g_new0 (YadListCol, n_cols);
+  for (i = 0, c = options.list_data.columns; c; i++, c = c->next)
     {
-      YadColumn *col = (YadColumn *) g_slist_nth_data (options.list_data.columns, i);
+      YadColumn *col = (YadColumn *) c->data;
 
-      switch (col->type)
-        {
-        case YAD_COLUMN_CHECK:
-        case YAD_COLUMN_RADIO:
-          ctypes[i] = G_TYPE_BOOLEAN;
-          break;
-        case YAD_COLUMN_NUM:
-        case YAD_COLUMN_SIZE:
-        case YAD_COLUMN_BAR:
-          ctypes[i] = G_TYPE_INT64;
-          break;
-        case YAD_COLUMN_FLOAT:
-          ctypes[i] = G_TYPE_DOUBLE;
-          break;
-        case YAD_COLUMN_IMAGE:
-          ctypes[i] = GDK_TYPE_PIXBUF;
-          break;
-        case YAD_COLUMN_ATTR_FORE:
-          ctypes[i] = G_TYPE_STRING;
-          fore_col = i;
-          break;
-        case YAD_COLUMN_ATTR_BACK:
-          ctypes[i] = G_TYPE_STRING;
-          back_col = i;
-          break;
-        case YAD_COLUMN_ATTR_FONT:
-          ctypes[i] = G_TYPE_STRING;
-          font_col = i;
-          break;
-        default:
-          ctypes[i] = G_TYPE_STRING;
-          break;
-        }
+      compile_column (&schema[i], col);
+      ctypes[i] = schema[i].gtype;
+
+      if (col->type == YAD_COLUMN_ATTR_FORE)
+        fore_col = i;
+      else if (col->type == YAD_COLUMN_ATTR_BACK)
+        back_col = i;
+      else if (col->type == YAD_COLUMN_ATTR_FONT)
+        font_col = i;
     }
 
-  store = gtk_tree_store_newv (n_cols, ctypes);
+  /* flat lists use compact model. trees and editable lists (which needs drag-n-drop
+     and rows operations from popup menu) still use GtkTreeStore */
+  if (options.list_data.tree_mode || options.common_data.editable)
+    model = GTK_TREE_MODEL (gtk_tree_store_newv (n_cols, ctypes));
+  else
+    model = GTK_TREE_MODEL (yad_list_model_new (n_cols, ctypes));
+  g_free (ctypes);
 
-  return GTK_TREE_MODEL (store);
+  return model;
 }
 
 static void
@@ -341,109 +682,433 @@ set_column_title (GtkTreeViewColumn *col, gchar *title)
 }
 
 static void
-add_columns ()
+filter_map_set (guint32 **map, guint *size, guint id, gboolean val)
 {
-  gint i;
-  GtkCellRenderer *renderer;
-  GtkTreeViewColumn *column;
-
-  for (i = 0; i < n_cols; i++)
+  if (id >= *size)
     {
-      YadColumn *col = (YadColumn *) g_slist_nth_data (options.list_data.columns, i);
+      guint n = MAX (id + 1, *size * 2);
 
-      if (i == options.list_data.hide_column - 1 || col->type == YAD_COLUMN_HIDDEN ||
-          i == fore_col || i == back_col || i == font_col)
-        continue;
+      n = (n + 31) & ~31U;
+      *map = g_renew (guint32, *map, n / 32);
+      memset (*map + *size / 32, 0, (n - *size) / 8);
+      *size = n;
+    }
 
-      switch (col->type)
-        {
-        case YAD_COLUMN_CHECK:
-        case YAD_COLUMN_RADIO:
-          renderer = gtk_cell_renderer_toggle_new ();
-          column = gtk_tree_view_column_new_with_attributes (NULL, renderer, "active", i, NULL);
-          set_column_title (column, col->name);
-          if (back_col != -1)
-            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
-          if (col->type == YAD_COLUMN_RADIO)
-            {
-              gtk_cell_renderer_toggle_set_radio (GTK_CELL_RENDERER_TOGGLE (renderer), TRUE);
-              g_signal_connect (renderer, "toggled", G_CALLBACK (rtoggled_cb), NULL);
-            }
-          else
-            g_signal_connect (renderer, "toggled", G_CALLBACK (toggled_cb), NULL);
-          break;
-        case YAD_COLUMN_IMAGE:
-          renderer = gtk_cell_renderer_pixbuf_new ();
-          column = gtk_tree_view_column_new_with_attributes (NULL, renderer, "pixbuf", i, NULL);
-          set_column_title (column, col->name);
-          if (back_col != -1)
-            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
-          break;
-        case YAD_COLUMN_NUM:
-        case YAD_COLUMN_SIZE:
-        case YAD_COLUMN_FLOAT:
-          renderer = gtk_cell_renderer_text_new ();
-          if (col->editable)
-            {
-              g_object_set (G_OBJECT (renderer), "editable", TRUE, NULL);
-              g_signal_connect (renderer, "edited", G_CALLBACK (cell_edited_cb), NULL);
-            }
-          column = gtk_tree_view_column_new_with_attributes (NULL, renderer, "text", i, NULL);
-          set_column_title (column, col->name);
-          if (fore_col != -1)
-            gtk_tree_view_column_add_attribute (column, renderer, "foreground", fore_col);
-          if (back_col != -1)
-            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
-          if (font_col != -1)
-            gtk_tree_view_column_add_attribute (column, renderer, "font", font_col);
-          gtk_tree_view_column_set_sort_column_id (column, i);
-          gtk_tree_view_column_set_resizable (column, TRUE);
-          if (col->type == YAD_COLUMN_FLOAT)
-            gtk_tree_view_column_set_cell_data_func (column, renderer, float_col_format, GINT_TO_POINTER (i), NULL);
-          else if (col->type == YAD_COLUMN_SIZE)
-            gtk_tree_view_column_set_cell_data_func (column, renderer, size_col_format, GINT_TO_POINTER (i), NULL);
-          break;
-        case YAD_COLUMN_BAR:
-          renderer = gtk_cell_renderer_progress_new ();
-          column = gtk_tree_view_column_new_with_attributes (NULL, renderer, "value", i, NULL);
-          set_column_title (column, col->name);
-          if (back_col != -1)
-            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
-          gtk_tree_view_column_set_sort_column_id (column, i);
-          gtk_tree_view_column_set_resizable (column, TRUE);
-          break;
-        default:
-          renderer = gtk_cell_renderer_text_new ();
-          if (col->editable)
-            {
-              g_object_set (G_OBJECT (renderer), "editable", TRUE, NULL);
-              g_signal_connect (renderer, "edited", G_CALLBACK (cell_edited_cb), NULL);
-            }
-          if (options.data.no_markup)
-            column = gtk_tree_view_column_new_with_attributes (NULL, renderer, "text", i, NULL);
-          else
-            column = gtk_tree_view_column_new_with_attributes (NULL, renderer, "markup", i, NULL);
-          set_column_title (column, col->name);
-          if (col->ellipsize)
-            g_object_set (G_OBJECT (renderer), "ellipsize", options.list_data.ellipsize, NULL);
-          if (col->wrap)
-            {
-              g_object_set (G_OBJECT (renderer), "wrap-width", options.list_data.wrap_width, NULL);
-              g_object_set (G_OBJECT (renderer), "wrap-mode", PANGO_WRAP_WORD_CHAR, NULL);
-            }
-          if (fore_col != -1)
-            gtk_tree_view_column_add_attribute (column, renderer, "foreground", fore_col);
-          if (back_col != -1)
-            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
-          if (font_col != -1)
-            gtk_tree_view_column_add_attribute (column, renderer, "font", font_col);
-          gtk_tree_view_column_set_sort_column_id (column, i);
-          gtk_tree_view_column_set_resizable (column, TRUE);
+  if (val)
+    (*map)[id >> 5] |= 1U << (id & 31);
+  else
+    (*map)[id >> 5] &= ~(1U << (id & 31));
+}
 
-          if (col->type == YAD_COLUMN_TIP)
-            options.list_data.tooltip_column = i + 1;
-          break;
-        }
+static gboolean
+filter_visible_func (GtkTreeModel *model, GtkTreeIter *iter, gpointer data)
+{
+  guint id;
+
+  if (filter_re == NULL)
+    return TRUE;
+
+  id = yad_list_model_get_row_id (YAD_LIST_MODEL (model), iter);
+  return (id < filter_size && FILTER_GET (filter_map, id));
+}
+
+/* new and changed rows are checked right away */
+static void
+filter_row_cb (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer data)
+{
+  guint id;
+  const gchar *str;
+
+  if (filter_re == NULL)
+    return;
+
+  id = yad_list_model_get_row_id (YAD_LIST_MODEL (model), iter);
+  str = yad_list_model_get_string (YAD_LIST_MODEL (model), iter, filter_col);
+  filter_map_set (&filter_map, &filter_size, id, g_regex_match (filter_re, str ? str : "", 0, NULL));
+
+  if (filter_cancel)
+    g_hash_table_add (filter_dirty, GUINT_TO_POINTER (id));
+}
+
+static void
+filter_refilter (void)
+{
+  /* don't let the view handle each row on big lists */
+  if (!detached && gtk_tree_model_iter_n_children (list_model, NULL) > LIST_DETACH_ROWS)
+    {
+      gtk_tree_view_set_model (GTK_TREE_VIEW (list_view), NULL);
+      gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (filter_model));
+      gtk_tree_view_set_model (GTK_TREE_VIEW (list_view), filter_model);
+    }
+  else
+    gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (filter_model));
+}
+
+static void
+filter_scan_free (YadFilterScan *scan)
+{
+  g_regex_unref (scan->re);
+  g_array_free (scan->ids, TRUE);
+  g_array_free (scan->offs, TRUE);
+  g_string_free (scan->text, TRUE);
+  g_free (scan->map);
+  g_free (scan);
+}
+
+static void
+filter_thread (GTask *task, gpointer src, gpointer data, GCancellable *cancel)
+{
+  YadFilterScan *scan = (YadFilterScan *) data;
+  guint i;
+
+  scan->map = g_new0 (guint32, scan->n_ids / 32);
+  for (i = 0; i < scan->ids->len; i++)
+    {
+      const gchar *str = scan->text->str + g_array_index (scan->offs, guint, i);
+
+      if ((i & 1023) == 0 && g_cancellable_is_cancelled (cancel))
+        {
+          g_task_return_boolean (task, FALSE);
+          return;
+        }
+
+      if (g_regex_match (scan->re, str, 0, NULL))
+        filter_map_set (&scan->map, &scan->n_ids, g_array_index (scan->ids, guint, i), TRUE);
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+filter_done_cb (GObject *src, GAsyncResult *res, gpointer data)
+{
+  YadFilterScan *scan;
+  GHashTableIter it;
+  gpointer id;
+
+  /* scan was cancelled by the next query */
+  if (!g_task_propagate_boolean (G_TASK (res), NULL))
+    return;
+
+  scan = (YadFilterScan *) g_task_get_task_data (G_TASK (res));
+
+  /* rows changed during the scan are already checked against current query */
+  g_hash_table_iter_init (&it, filter_dirty);
+  while (g_hash_table_iter_next (&it, &id, NULL))
+    {
+      guint n = GPOINTER_TO_UINT (id);
+      filter_map_set (&scan->map, &scan->n_ids, n, n < filter_size && FILTER_GET (filter_map, n));
+    }
+  g_hash_table_remove_all (filter_dirty);
+
+  g_free (filter_map);
+  filter_map = scan->map;
+  filter_size = scan->n_ids;
+  scan->map = NULL;
+
+  g_clear_object (&filter_cancel);
+  filter_complete = TRUE;
+
+  filter_refilter ();
+}
+
+static void
+filter_changed_cb (GtkSearchEntry *entry, gpointer data)
+{
+  const gchar *key = gtk_entry_get_text (GTK_ENTRY (entry));
+  YadFilterScan *scan;
+  GtkTreeIter iter;
+  GRegex *re;
+  GTask *task;
+  gboolean narrow;
+
+  if (!key[0])
+    re = NULL;
+  else if (options.list_data.regex_search)
+    {
+      re = g_regex_new (key, G_REGEX_CASELESS | G_REGEX_EXTENDED | G_REGEX_OPTIMIZE, 0, NULL);
+      /* keep current results while pattern is incomplete */
+      if (re == NULL)
+        return;
+    }
+  else
+    {
+      gchar *str = g_regex_escape_string (key, -1);
+      re = g_regex_new (str, G_REGEX_CASELESS | G_REGEX_OPTIMIZE, 0, NULL);
+      g_free (str);
+    }
+
+  if (filter_cancel)
+    {
+      g_cancellable_cancel (filter_cancel);
+      g_clear_object (&filter_cancel);
+      g_hash_table_remove_all (filter_dirty);
+    }
+
+  /* longer substring can match only the rows already shown */
+  narrow = (re && filter_re && filter_complete && !options.list_data.regex_search &&
+            strstr (key, filter_text) != NULL);
+
+  if (filter_re)
+    g_regex_unref (filter_re);
+  filter_re = re;
+  g_free (filter_text);
+  filter_text = g_strdup (key);
+  filter_complete = FALSE;
+
+  if (re == NULL)
+    {
+      filter_refilter ();
+      return;
+    }
+
+  /* take a snapshot of searched text */
+  scan = g_new0 (YadFilterScan, 1);
+  scan->re = g_regex_ref (re);
+  scan->ids = g_array_new (FALSE, FALSE, sizeof (guint));
+  scan->offs = g_array_new (FALSE, FALSE, sizeof (guint));
+  scan->text = g_string_sized_new (4096);
+
+  if (gtk_tree_model_get_iter_first (list_model, &iter))
+    {
+      do
+        {
+          guint id = yad_list_model_get_row_id (YAD_LIST_MODEL (list_model), &iter);
+          const gchar *str;
+          guint off;
+
+          if (narrow && !(id < filter_size && FILTER_GET (filter_map, id)))
+            continue;
+
+          str = yad_list_model_get_string (YAD_LIST_MODEL (list_model), &iter, filter_col);
+          off = scan->text->len;
+          g_string_append (scan->text, str ? str : "");
+          g_string_append_c (scan->text, '\0');
+
+          g_array_append_val (scan->ids, id);
+          g_array_append_val (scan->offs, off);
+          if (id >= scan->n_ids)
+            scan->n_ids = id + 1;
+        }
+      while (gtk_tree_model_iter_next (list_model, &iter));
+    }
+  scan->n_ids = (scan->n_ids + 32) & ~31U;
+
+  filter_cancel = g_cancellable_new ();
+  task = g_task_new (NULL, filter_cancel, filter_done_cb, NULL);
+  g_task_set_task_data (task, scan, (GDestroyNotify) filter_scan_free);
+  g_task_run_in_thread (task, filter_thread);
+  g_object_unref (task);
+}
+
+/* typing in the list goes to the filter entry */
+static gboolean
+filter_key_cb (GtkWidget *w, GdkEventKey *ev, gpointer data)
+{
+  return gtk_search_entry_handle_event (GTK_SEARCH_ENTRY (data), (GdkEvent *) ev);
+}
+
+/* filter model is not sortable, so view columns don't track sorting by themselves */
+static void
+set_sort_indicator (gint num, GtkSortType order)
+{
+  GList *cols, *c;
+
+  cols = gtk_tree_view_get_columns (GTK_TREE_VIEW (list_view));
+  for (c = cols; c; c = c->next)
+    {
+      GtkTreeViewColumn *column = GTK_TREE_VIEW_COLUMN (c->data);
+      gboolean cur = (GPOINTER_TO_INT (g_object_get_data (G_OBJECT (column), "sort-column")) == num + 1);
+
+      gtk_tree_view_column_set_sort_indicator (column, cur);
+      if (cur)
+        gtk_tree_view_column_set_sort_order (column, order);
+    }
+  g_list_free (cols);
+}
+
+static void
+sort_clicked_cb (GtkTreeViewColumn *column, gpointer data)
+{
+  gint col = GPOINTER_TO_INT (data);
+  gint cur;
+  GtkSortType order = GTK_SORT_ASCENDING;
+
+  if (gtk_tree_sortable_get_sort_column_id (GTK_TREE_SORTABLE (list_model), &cur, &order) &&
+      cur == col && order == GTK_SORT_ASCENDING)
+    order = GTK_SORT_DESCENDING;
+  else
+    order = GTK_SORT_ASCENDING;
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (list_model), col, order);
+  set_sort_indicator (col, order);
+}
+
+static void
+set_sort_column (GtkTreeViewColumn *column, gint num)
+{
+  if (filter_model)
+    {
+      g_object_set_data (G_OBJECT (column), "sort-column", GINT_TO_POINTER (num + 1));
+      g_signal_connect (G_OBJECT (column), "clicked", G_CALLBACK (sort_clicked_cb), GINT_TO_POINTER (num));
+    }
+  else
+    gtk_tree_view_column_set_sort_column_id (column, num);
+}
+
+/* apply initial sorting from --sort-by. columns are separated by comma,
+   negative number means descending order */
+static void
+apply_sort (void)
+{
+  static gboolean applied = FALSE;
+  gchar **specs;
+  gint *cols, n = 0, i;
+  GtkSortType *orders;
+
+  if (applied || options.list_data.sort_by == NULL)
+    return;
+  applied = TRUE;
+
+  cols = g_new (gint, n_cols);
+  orders = g_new (GtkSortType, n_cols);
+
+  specs = g_strsplit (options.list_data.sort_by, ",", -1);
+  for (i = 0; specs[i] && n < n_cols; i++)
+    {
+      gint c = atoi (specs[i]);
+
+      if (c == 0 || ABS (c) > n_cols)
+        {
+          g_printerr (_("Wrong sort column: %s\n"), specs[i]);
+          continue;
+        }
+      cols[n] = ABS (c) - 1;
+      orders[n] = (c < 0) ? GTK_SORT_DESCENDING : GTK_SORT_ASCENDING;
+      n++;
+    }
+  g_strfreev (specs);
+
+  if (n > 0)
+    {
+      if (YAD_IS_LIST_MODEL (list_model))
+        yad_list_model_set_sort_keys (YAD_LIST_MODEL (list_model), n, cols, orders);
+      else
+        {
+          if (n > 1 && options.debug)
+            g_printerr (_("WARNING: only first sort column is used in tree mode and for editable lists\n"));
+          gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (list_model), cols[0], orders[0]);
+        }
+
+      if (filter_model)
+        set_sort_indicator (cols[0], orders[0]);
+    }
+
+  g_free (cols);
+  g_free (orders);
+}
+
+static void
+add_columns ()
+{
+  gint i;
+  GtkCellRenderer *renderer;
+  GtkTreeViewColumn *column;
+
+  for (i = 0; i < n_cols; i++)
+    {
+      YadColumn *col = schema[i].col;
+
+      if (i == options.list_data.hide_column - 1 || col->type == YAD_COLUMN_HIDDEN ||
+          i == fore_col || i == back_col || i == font_col)
+        continue;
+
+      switch (col->type)
+        {
+        case YAD_COLUMN_CHECK:
+        case YAD_COLUMN_RADIO:
+          renderer = gtk_cell_renderer_toggle_new ();
+          column = gtk_tree_view_column_new_with_attributes (NULL, renderer, schema[i].attr, i, NULL);
+          set_column_title (column, col->name);
+          if (back_col != -1)
+            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
+          if (col->type == YAD_COLUMN_RADIO)
+            {
+              gtk_cell_renderer_toggle_set_radio (GTK_CELL_RENDERER_TOGGLE (renderer), TRUE);
+              g_signal_connect (renderer, "toggled", G_CALLBACK (rtoggled_cb), NULL);
+            }
+          else
+            g_signal_connect (renderer, "toggled", G_CALLBACK (toggled_cb), NULL);
+          break;
+        case YAD_COLUMN_IMAGE:
+          renderer = gtk_cell_renderer_pixbuf_new ();
+          column = gtk_tree_view_column_new_with_attributes (NULL, renderer, schema[i].attr, i, NULL);
+          set_column_title (column, col->name);
+          if (back_col != -1)
+            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
+          break;
+        case YAD_COLUMN_NUM:
+        case YAD_COLUMN_SIZE:
+        case YAD_COLUMN_FLOAT:
+          renderer = gtk_cell_renderer_text_new ();
+          if (col->editable)
+            {
+              g_object_set (G_OBJECT (renderer), "editable", TRUE, NULL);
+              g_signal_connect (renderer, "edited", G_CALLBACK (cell_edited_cb), NULL);
+            }
+          column = gtk_tree_view_column_new_with_attributes (NULL, renderer, schema[i].attr, i, NULL);
+          set_column_title (column, col->name);
+          if (fore_col != -1)
+            gtk_tree_view_column_add_attribute (column, renderer, "foreground", fore_col);
+          if (back_col != -1)
+            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
+          if (font_col != -1)
+            gtk_tree_view_column_add_attribute (column, renderer, "font", font_col);
+          set_sort_column (column, i);
+          gtk_tree_view_column_set_resizable (column, TRUE);
+          if (col->type == YAD_COLUMN_FLOAT)
+            gtk_tree_view_column_set_cell_data_func (column, renderer, float_col_format, GINT_TO_POINTER (i), NULL);
+          else if (col->type == YAD_COLUMN_SIZE)
+            gtk_tree_view_column_set_cell_data_func (column, renderer, size_col_format, GINT_TO_POINTER (i), NULL);
+          break;
+        case YAD_COLUMN_BAR:
+          renderer = gtk_cell_renderer_progress_new ();
+          column = gtk_tree_view_column_new_with_attributes (NULL, renderer, schema[i].attr, i, NULL);
+          set_column_title (column, col->name);
+          if (back_col != -1)
+            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
+          set_sort_column (column, i);
+          gtk_tree_view_column_set_resizable (column, TRUE);
+          break;
+        default:
+          renderer = gtk_cell_renderer_text_new ();
+          if (col->editable)
+            {
+              g_object_set (G_OBJECT (renderer), "editable", TRUE, NULL);
+              g_signal_connect (renderer, "edited", G_CALLBACK (cell_edited_cb), NULL);
+            }
+          column = gtk_tree_view_column_new_with_attributes (NULL, renderer, schema[i].attr, i, NULL);
+          set_column_title (column, col->name);
+          if (col->ellipsize)
+            g_object_set (G_OBJECT (renderer), "ellipsize", options.list_data.ellipsize, NULL);
+          if (col->wrap)
+            {
+              g_object_set (G_OBJECT (renderer), "wrap-width", options.list_data.wrap_width, NULL);
+              g_object_set (G_OBJECT (renderer), "wrap-mode", PANGO_WRAP_WORD_CHAR, NULL);
+            }
+          if (fore_col != -1)
+            gtk_tree_view_column_add_attribute (column, renderer, "foreground", fore_col);
+          if (back_col != -1)
+            gtk_tree_view_column_add_attribute (column, renderer, "cell-background", back_col);
+          if (font_col != -1)
+            gtk_tree_view_column_add_attribute (column, renderer, "font", font_col);
+          set_sort_column (column, i);
+          gtk_tree_view_column_set_resizable (column, TRUE);
+
+          if (col->type == YAD_COLUMN_TIP)
+            options.list_data.tooltip_column = i + 1;
+          break;
+        }
 
       gtk_cell_renderer_set_alignment (renderer, col->c_align, 0.5);
       g_object_set_data (G_OBJECT (renderer), "column", GINT_TO_POINTER (i));
@@ -452,6 +1117,22 @@ add_columns ()
       gtk_tree_view_column_set_clickable (column, options.list_data.clickable);
       gtk_tree_view_column_set_alignment (column, col->h_align);
 
+      if (options.list_data.fixed_layout)
+        {
+          gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+          if (col->width > 0)
+            gtk_tree_view_column_set_fixed_width (column, col->width);
+          else
+            {
+              gint hw = 0;
+
+              /* initial width is the width of header, it will be enlarged after loading the data */
+              if (!options.list_data.no_headers)
+                gtk_widget_get_preferred_width (gtk_tree_view_column_get_button (column), NULL, &hw);
+              gtk_tree_view_column_set_fixed_width (column, MAX (hw, 1));
+            }
+        }
+
       if (col->type != YAD_COLUMN_CHECK && col->type != YAD_COLUMN_IMAGE)
         {
           if (i == options.list_data.expand_column - 1 || options.list_data.expand_column == 0)
@@ -459,6 +1140,10 @@ add_columns ()
         }
     }
 
+  /* all rows have the same height, so view measures only visible ones */
+  if (options.list_data.fixed_layout)
+    gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (list_view), TRUE);
+
   if (options.list_data.checkbox && !options.list_data.search_column)
     options.list_data.search_column += 1;
   if (options.list_data.search_column <= n_cols)
@@ -471,269 +1156,1068 @@ add_columns ()
 static void
 cell_set_data (GtkTreeIter *it, guint num, gchar *data)
 {
-  GtkTreeModel *model = gtk_tree_view_get_model (GTK_TREE_VIEW (list_view));
-  YadColumn *col = (YadColumn *) g_slist_nth_data (options.list_data.columns, num);
+  GValue val = G_VALUE_INIT;
 
-  switch (col->type)
+  if (schema[num].parse (data, &val))
     {
-    case YAD_COLUMN_CHECK:
-    case YAD_COLUMN_RADIO:
-        gtk_tree_store_set (GTK_TREE_STORE (model), it, num, get_bool_val (data), -1);
-      break;
-    case YAD_COLUMN_NUM:
-    case YAD_COLUMN_SIZE:
-      gtk_tree_store_set (GTK_TREE_STORE (model), it, num, g_ascii_strtoll (data, NULL, 10), -1);
-      break;
-    case YAD_COLUMN_FLOAT:
-      gtk_tree_store_set (GTK_TREE_STORE (model), it, num, g_ascii_strtod (data, NULL), -1);
-      break;
-    case YAD_COLUMN_BAR:
-      {
-        gint64 val = g_ascii_strtoll (data, NULL, 10);
-        if (val < 0)
-          val = 0;
-        if (val > 100)
-          val = 100;
-        gtk_tree_store_set (GTK_TREE_STORE (model), it, num, val, -1);
-        break;
-      }
-    case YAD_COLUMN_IMAGE:
-      {
-        GdkPixbuf *pb;
-
-        if (g_file_test (data, G_FILE_TEST_EXISTS))
-          pb = get_pixbuf (data, YAD_SMALL_ICON, FALSE);
-        else
-          pb = get_pixbuf (data, YAD_SMALL_ICON, TRUE);
-        if (pb)
-          {
-            gtk_tree_store_set (GTK_TREE_STORE (model), it, num, pb, -1);
-            g_object_unref (pb);
-          }
-        break;
-      }
-    default:
-      if (data && *data)
-        gtk_tree_store_set (GTK_TREE_STORE (model), it, num, data, -1);
-      break;
+      if (YAD_IS_LIST_MODEL (list_model))
+        yad_list_model_set_value (YAD_LIST_MODEL (list_model), it, num, &val);
+      else
+        gtk_tree_store_set_value (GTK_TREE_STORE (list_model), it, num, &val);
+      g_value_unset (&val);
     }
 }
 
-static gchar *
-cell_get_data (GtkTreeIter *it, guint num)
+static gchar *
+cell_get_data (GtkTreeIter *it, guint num)
+{
+  return schema[num].format (list_model, it, num);
+}
+
+/* key is a string representation of column value, so "007" and "7" are the same keys in numeric column */
+static gchar *
+value_to_key (const GValue *val)
+{
+  GValue str = G_VALUE_INIT;
+  gchar *key = NULL;
+
+  g_value_init (&str, G_TYPE_STRING);
+  if (g_value_transform (val, &str))
+    key = g_value_dup_string (&str);
+  g_value_unset (&str);
+
+  return key;
+}
+
+static gchar *
+data_key (gchar *data)
+{
+  GValue val = G_VALUE_INIT;
+  gchar *key = NULL;
+
+  if (schema[key_col].parse (data, &val))
+    {
+      key = value_to_key (&val);
+      g_value_unset (&val);
+    }
+
+  return key;
+}
+
+static gchar *
+row_key (GtkTreeIter *it)
+{
+  GValue val = G_VALUE_INIT;
+  gchar *key;
+
+  gtk_tree_model_get_value (list_model, it, key_col, &val);
+  key = value_to_key (&val);
+  g_value_unset (&val);
+
+  return key;
+}
+
+/* remove node and all its children from tree index */
+static void
+forget_node (GtkTreeIter *it)
+{
+  GtkTreeIter child;
+  gchar *id;
+
+  if (gtk_tree_model_iter_children (list_model, &child, it))
+    {
+      do
+        forget_node (&child);
+      while (gtk_tree_model_iter_next (list_model, &child));
+    }
+
+  if (lazy_nodes)
+    g_hash_table_remove (lazy_nodes, it->user_data);
+
+  id = g_hash_table_lookup (node_ids, it->user_data);
+  if (id)
+    {
+      g_hash_table_remove (node_ids, it->user_data);
+      g_hash_table_remove (row_hash, id);
+    }
+}
+
+static void
+remember_node (gchar *id, GtkTreeIter *it)
+{
+  GtkTreeIter *old = g_hash_table_lookup (row_hash, id);
+
+  /* old node with the same id stays in the tree but loses its id */
+  if (old)
+    g_hash_table_remove (node_ids, old->user_data);
+
+  g_hash_table_replace (row_hash, id, gtk_tree_iter_copy (it));
+  g_hash_table_insert (node_ids, it->user_data, id);
+}
+
+static void
+add_placeholder (GtkTreeIter *it)
+{
+  GtkTreeIter dummy;
+
+  gtk_tree_store_append (GTK_TREE_STORE (list_model), &dummy, it);
+  g_hash_table_insert (lazy_nodes, it->user_data, gtk_tree_iter_copy (&dummy));
+}
+
+static void
+drop_placeholder (GtkTreeIter *it)
+{
+  GtkTreeIter *dummy = g_hash_table_lookup (lazy_nodes, it->user_data);
+
+  if (dummy)
+    {
+      gtk_tree_store_remove (GTK_TREE_STORE (list_model), dummy);
+      g_hash_table_remove (lazy_nodes, it->user_data);
+    }
+}
+
+/* all children of the node are added */
+static void
+tree_loaded (const gchar *id)
+{
+  GtkTreeIter *it;
+
+  g_hash_table_remove (lazy_loading, id);
+  it = g_hash_table_lookup (row_hash, id);
+  if (it)
+    drop_placeholder (it);
+}
+
+static gboolean
+is_placeholder (GtkTreeIter *it)
+{
+  GtkTreeIter parent, *dummy;
+
+  if (lazy_nodes == NULL || !gtk_tree_model_iter_parent (list_model, &parent, it))
+    return FALSE;
+
+  dummy = g_hash_table_lookup (lazy_nodes, parent.user_data);
+  return (dummy && dummy->user_data == it->user_data);
+}
+
+static void
+remove_row (GtkTreeIter *it)
+{
+  /* iter may be owned by key or tree index */
+  GtkTreeIter iter = *it;
+  GtkTreeIter parent;
+
+  /* keep the number of top level rows right for --limit */
+  if (!gtk_tree_model_iter_parent (list_model, &parent, &iter) && n_top_rows > 0)
+    n_top_rows--;
+
+  if (row_hash)
+    forget_node (&iter);
+
+  if (key_hash)
+    {
+      gchar *key = row_key (&iter);
+      if (key)
+        {
+          g_hash_table_remove (key_hash, key);
+          g_free (key);
+        }
+    }
+
+  if (YAD_IS_LIST_MODEL (list_model))
+    yad_list_model_remove (YAD_LIST_MODEL (list_model), &iter);
+  else
+    gtk_tree_store_remove (GTK_TREE_STORE (list_model), &iter);
+}
+
+static gboolean
+cell_parse (guint num, gchar *data, GValue *val, gboolean update)
+{
+  if (schema[num].parse (data, val))
+    return TRUE;
+
+  /* empty text must clear the old value on update */
+  if (update && schema[num].gtype == G_TYPE_STRING)
+    {
+      g_value_init (val, G_TYPE_STRING);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* convert row data to the values. returns number of values */
+static guint
+row_values (YadListRow *row, gint *cols, GValue *values, gboolean update)
+{
+  guint i, n = 0;
+
+  for (i = 0; i < row->n_data; i++)
+    {
+      if (cell_parse (i, row->data[i], &values[n], update))
+        {
+          cols[n] = i;
+          n++;
+        }
+    }
+
+  return n;
+}
+
+/* apply control operation to the row with given key */
+static void
+control_row (YadListRow *row)
+{
+  GtkTreeIter *it;
+  gchar *key;
+
+  if (!key_hash)
+    return;
+
+  key = data_key (row->key);
+  it = key ? g_hash_table_lookup (key_hash, key) : NULL;
+  if (it == NULL)
+    {
+      if (options.debug)
+        g_printerr (_("yad_list: row with key '%s' not found\n"), row->key);
+      g_free (key);
+      return;
+    }
+
+  if (row->op == LIST_ROW_DEL)
+    remove_row (it);
+  else
+    {
+      GValue val = G_VALUE_INIT;
+
+      if (row->col == (guint) key_col)
+        {
+          gchar *new_key = data_key (row->data[0]);
+
+          /* change key only if new one is unique */
+          if (!new_key || g_hash_table_contains (key_hash, new_key))
+            {
+              g_free (new_key);
+              g_free (key);
+              return;
+            }
+          it = gtk_tree_iter_copy (it);
+          g_hash_table_remove (key_hash, key);
+          g_hash_table_insert (key_hash, new_key, it);
+        }
+
+      if (cell_parse (row->col, row->data[0], &val, TRUE))
+        {
+          yad_list_model_set_value (YAD_LIST_MODEL (list_model), it, row->col, &val);
+          g_value_unset (&val);
+        }
+    }
+
+  g_free (key);
+}
+
+static gboolean insert_row (YadListRow *row, GtkTreeIter *iter);
+
+static void
+free_orphans (GSList *kids)
+{
+  g_slist_free_full (kids, (GDestroyNotify) list_row_free);
+}
+
+/* keep row until its parent is added. row data is moved to the buffer */
+static void
+buffer_orphan (YadListRow *row)
+{
+  YadListRow *orphan = g_new (YadListRow, 1);
+  GSList *kids;
+
+  *orphan = *row;
+  memset (row, 0, sizeof (YadListRow));
+
+  /* key is owned by the first buffered child */
+  kids = g_hash_table_lookup (orphans, orphan->pid);
+  if (kids)
+    kids->next = g_slist_prepend (kids->next, orphan);
+  else
+    g_hash_table_insert (orphans, orphan->pid, g_slist_prepend (NULL, orphan));
+}
+
+static void
+adopt_orphans (const gchar *id)
+{
+  GSList *kids, *k;
+  GtkTreeIter iter;
+
+  kids = g_hash_table_lookup (orphans, id);
+  if (kids == NULL)
+    return;
+  g_hash_table_steal (orphans, id);
+
+  /* first child is at the head, others are in reverse order */
+  kids->next = g_slist_reverse (kids->next);
+  for (k = kids; k; k = k->next)
+    {
+      YadListRow *row = (YadListRow *) k->data;
+      insert_row (row, &iter);
+      list_row_free (row);
+    }
+  g_slist_free (kids);
+}
+
+/* add rows which parents never came as top level ones */
+static void
+flush_orphans ()
+{
+  GHashTable *ids;
+  GHashTableIter it;
+  GSList *kids, *k, *roots = NULL;
+  gpointer val;
+
+  if (orphans == NULL || g_hash_table_size (orphans) == 0)
+    return;
+
+  ids = g_hash_table_new (g_str_hash, g_str_equal);
+  g_hash_table_iter_init (&it, orphans);
+  while (g_hash_table_iter_next (&it, NULL, &val))
+    {
+      for (k = (GSList *) val; k; k = k->next)
+        {
+          YadListRow *row = (YadListRow *) k->data;
+          if (row->id)
+            g_hash_table_add (ids, row->id);
+        }
+    }
+
+  /* children of buffered rows stay in the buffer and will be adopted by their parents */
+  g_hash_table_iter_init (&it, orphans);
+  while (g_hash_table_iter_next (&it, NULL, &val))
+    {
+      kids = (GSList *) val;
+      if (!g_hash_table_contains (ids, ((YadListRow *) kids->data)->pid))
+        {
+          g_hash_table_iter_steal (&it);
+          kids->next = g_slist_reverse (kids->next);
+          roots = g_slist_concat (roots, kids);
+        }
+    }
+  g_hash_table_destroy (ids);
+
+  for (k = roots; k; k = k->next)
+    {
+      YadListRow *row = (YadListRow *) k->data;
+      GtkTreeIter iter;
+
+      g_free (row->pid);
+      row->pid = NULL;
+      insert_row (row, &iter);
+      list_row_free (row);
+    }
+  g_slist_free (roots);
+}
+
+/* add new row or update existing one with the same key. returns TRUE if row was added */
+static gboolean
+insert_row (YadListRow *row, GtkTreeIter *iter)
+{
+  GtkTreeIter *parent = NULL;
+  GValue *values;
+  gint *cols;
+  gchar *key = NULL;
+  guint i, n;
+  gboolean orphan = FALSE;
+
+  if (row->pid && row->pid[0])
+    {
+      parent = g_hash_table_lookup (row_hash, row->pid);
+      orphan = (parent == NULL);
+    }
+
+  values = g_newa (GValue, n_cols);
+  memset (values, 0, n_cols * sizeof (GValue));
+  cols = g_newa (gint, n_cols);
+
+  if (key_hash && row->n_data > (guint) key_col)
+    {
+      key = data_key (row->data[key_col]);
+      if (key)
+        {
+          GtkTreeIter *it = g_hash_table_lookup (key_hash, key);
+          if (it)
+            {
+              /* update row in place */
+              n = row_values (row, cols, values, TRUE);
+              yad_list_model_set_valuesv (YAD_LIST_MODEL (list_model), it, cols, values, n);
+              for (i = 0; i < n; i++)
+                g_value_unset (&values[i]);
+              *iter = *it;
+              g_free (key);
+              return FALSE;
+            }
+        }
+    }
+
+  if (orphan)
+    {
+      g_free (key);
+      buffer_orphan (row);
+      return FALSE;
+    }
+
+  n = row_values (row, cols, values, FALSE);
+
+  /* insert the whole row at once, so the view gets only one row-inserted signal */
+  if (YAD_IS_LIST_MODEL (list_model))
+    yad_list_model_insert_with_valuesv (YAD_LIST_MODEL (list_model), iter,
+                                        options.list_data.add_on_top ? 0 : -1, cols, values, n);
+  else
+    gtk_tree_store_insert_with_valuesv (GTK_TREE_STORE (list_model), iter, parent,
+                                        options.list_data.add_on_top ? 0 : -1, cols, values, n);
+
+  for (i = 0; i < n; i++)
+    g_value_unset (&values[i]);
+
+  if (key)
+    g_hash_table_insert (key_hash, key, gtk_tree_iter_copy (iter));
+
+  if (parent == NULL)
+    n_top_rows++;
+
+  if (lazy_nodes)
+    {
+      /* node with real children is loaded */
+      if (parent)
+        drop_placeholder (parent);
+      if (row->id && row->id[0])
+        add_placeholder (iter);
+    }
+
+  if (row->id && row->id[0])
+    {
+      gchar *id = row->id;
+
+      row->id = NULL;
+      remember_node (id, iter);
+      if (g_hash_table_size (orphans) > 0)
+        {
+          /* adopted children may change iter */
+          GtkTreeIter it = *iter;
+          adopt_orphans (id);
+          *iter = it;
+        }
+    }
+
+  return TRUE;
+}
+
+/* set widths of fixed columns from the first rows of the list. widths only grows,
+   so this may be called several times while the list is not filled enough */
+static void
+estimate_widths (gboolean final)
+{
+  GList *cols, *c;
+  GtkTreeIter iter;
+  gint *widths, n = 0;
+
+  if (widths_done)
+    return;
+
+  cols = gtk_tree_view_get_columns (GTK_TREE_VIEW (list_view));
+  widths = g_new0 (gint, g_list_length (cols));
+
+  if (gtk_tree_model_get_iter_first (list_model, &iter))
+    {
+      do
+        {
+          gint i = 0;
+
+          if (is_placeholder (&iter))
+            continue;
+
+          for (c = cols; c; c = c->next, i++)
+            {
+              GtkTreeViewColumn *column = (GtkTreeViewColumn *) c->data;
+              gint w = 0;
+
+              gtk_tree_view_column_cell_set_cell_data (column, list_model, &iter, FALSE, FALSE);
+              gtk_tree_view_column_cell_get_size (column, NULL, NULL, NULL, &w, NULL);
+              widths[i] = MAX (widths[i], w);
+            }
+          n++;
+        }
+      while (n < LIST_SAMPLE_ROWS && gtk_tree_model_iter_next (list_model, &iter));
+    }
+
+  if (n > 0)
+    {
+      gint i = 0;
+
+      for (c = cols; c; c = c->next, i++)
+        {
+          GtkTreeViewColumn *column = (GtkTreeViewColumn *) c->data;
+          GtkCellRenderer *r = NULL;
+          GList *cells;
+          YadColumn *col;
+
+          cells = gtk_cell_layout_get_cells (GTK_CELL_LAYOUT (column));
+          if (cells)
+            r = (GtkCellRenderer *) cells->data;
+          g_list_free (cells);
+          if (r == NULL)
+            continue;
+
+          /* explicitly set width is kept as is */
+          col = schema[GPOINTER_TO_INT (g_object_get_data (G_OBJECT (r), "column"))].col;
+          if (col->width > 0)
+            continue;
+
+          if (widths[i] > gtk_tree_view_column_get_fixed_width (column))
+            gtk_tree_view_column_set_fixed_width (column, widths[i]);
+        }
+    }
+
+  widths_done = final || n >= LIST_SAMPLE_ROWS;
+
+  g_free (widths);
+  g_list_free (cols);
+}
+
+/* remove the oldest rows which exceed the limit. done once per batch of added rows */
+static void
+trim_list ()
+{
+  GtkTreeIter iter, next;
+  guint i, n, pos;
+
+  if (!options.list_data.limit || n_top_rows <= options.list_data.limit)
+    return;
+
+  n = n_top_rows - options.list_data.limit;
+  pos = options.list_data.add_on_top ? options.list_data.limit : 0;
+
+  if (gtk_tree_model_iter_nth_child (list_model, &iter, NULL, pos))
+    {
+      for (i = 0; i < n; i++)
+        {
+          gboolean has_next;
+
+          /* iterators are persistent, so next row is still valid after removing */
+          next = iter;
+          has_next = gtk_tree_model_iter_next (list_model, &next);
+          remove_row (&iter);
+          if (!has_next)
+            break;
+          iter = next;
+        }
+    }
+}
+
+static void
+clear_list ()
+{
+  GtkTreeSelection *sel = gtk_tree_view_get_selection (GTK_TREE_VIEW (list_view));
+
+  g_queue_free_full (pending_rows, (GDestroyNotify) list_row_free);
+  pending_rows = g_queue_new ();
+  list_row_free (cur_row);
+  cur_row = NULL;
+
+  if (select_hndl)
+    g_signal_handler_block (G_OBJECT (sel), select_hndl);
+  if (YAD_IS_LIST_MODEL (list_model))
+    yad_list_model_clear (YAD_LIST_MODEL (list_model));
+  else
+    gtk_tree_store_clear (GTK_TREE_STORE (list_model));
+  n_top_rows = 0;
+  if (row_hash)
+    {
+      g_hash_table_remove_all (node_ids);
+      g_hash_table_remove_all (row_hash);
+      g_hash_table_remove_all (orphans);
+    }
+  if (lazy_nodes)
+    {
+      g_hash_table_remove_all (lazy_nodes);
+      g_hash_table_remove_all (lazy_loading);
+    }
+  if (key_hash)
+    g_hash_table_remove_all (key_hash);
+  if (select_hndl)
+    g_signal_handler_unblock (G_OBJECT (sel), select_hndl);
+
+  loaded_rows = 0;
+  load_start = 0;
+}
+
+static gboolean
+tail_scroll_cb (GtkWidget *w, GdkFrameClock *clock, gpointer data)
+{
+  GtkTreePath *path = gtk_tree_row_reference_get_path (tail_ref);
+
+  if (path && filter_model)
+    {
+      GtkTreePath *cpath = path;
+
+      path = gtk_tree_model_filter_convert_child_path_to_path (GTK_TREE_MODEL_FILTER (filter_model), cpath);
+      gtk_tree_path_free (cpath);
+    }
+
+  if (path)
+    {
+      gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (list_view), path, NULL, FALSE, 1.0, 1.0);
+      gtk_tree_path_free (path);
+    }
+
+  gtk_tree_row_reference_free (tail_ref);
+  tail_ref = NULL;
+  tail_tick = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+flush_rows (gpointer data)
+{
+  GtkTreeIter iter, last;
+  gint64 start;
+  guint cnt = 0;
+  gboolean added = FALSE;
+
+  start = g_get_monotonic_time ();
+
+  /* in ring mode rows which will be evicted anyway are dropped without inserting.
+     all rows in flat list without key index are the new ones */
+  if (options.list_data.limit && !key_hash && !options.list_data.tree_mode)
+    {
+      while (g_queue_get_length (pending_rows) > options.list_data.limit)
+        {
+          list_row_free ((YadListRow *) g_queue_pop_head (pending_rows));
+          loaded_rows++;
+        }
+    }
+
+  /* for big bursts detach model from view, so the view doesn't handle each inserted row.
+     don't do this if user already select something */
+  if (!detached && g_queue_get_length (pending_rows) > LIST_DETACH_ROWS)
+    {
+      GtkTreeSelection *sel = gtk_tree_view_get_selection (GTK_TREE_VIEW (list_view));
+
+      if (gtk_tree_selection_count_selected_rows (sel) == 0)
+        {
+          gtk_tree_view_set_model (GTK_TREE_VIEW (list_view), NULL);
+          detached = TRUE;
+        }
+    }
+
+  while (!g_queue_is_empty (pending_rows))
+    {
+      YadListRow *row = (YadListRow *) g_queue_pop_head (pending_rows);
+
+      if (row->op == LIST_ROW_LOADED)
+        tree_loaded (row->key);
+      else if (row->op != LIST_ROW_ADD)
+        {
+          control_row (row);
+          /* last added row may be removed */
+          if (row->op == LIST_ROW_DEL)
+            added = FALSE;
+        }
+      else if (insert_row (row, &iter))
+        {
+          last = iter;
+          added = TRUE;
+        }
+      list_row_free (row);
+      loaded_rows++;
+      cnt++;
+
+      /* keep ui responsive */
+      if ((cnt & 63) == 0 && g_get_monotonic_time () - start > LIST_FRAME_BUDGET)
+        break;
+    }
+
+  if (added && options.common_data.tail)
+    {
+      GtkTreePath *path = gtk_tree_model_get_path (list_model, &last);
+
+      if (tail_ref)
+        gtk_tree_row_reference_free (tail_ref);
+      tail_ref = gtk_tree_row_reference_new (list_model, path);
+      gtk_tree_path_free (path);
+    }
+
+  trim_list ();
+
+  if (options.list_data.fixed_layout)
+    estimate_widths (load_done && g_queue_is_empty (pending_rows));
+
+  if (g_queue_is_empty (pending_rows) && detached)
+    {
+      gtk_tree_view_set_model (GTK_TREE_VIEW (list_view), filter_model ? filter_model : list_model);
+      detached = FALSE;
+    }
+
+  /* scroll at most once per frame */
+  if (tail_ref && !detached && tail_tick == 0)
+    tail_tick = gtk_widget_add_tick_callback (list_view, tail_scroll_cb, NULL, NULL);
+
+  if (!g_queue_is_empty (pending_rows))
+    return G_SOURCE_CONTINUE;
+
+  if (load_done && row_hash)
+    flush_orphans ();
+
+  /* sort all loaded rows at once instead of sorted insertion of each row */
+  if (load_done || options.common_data.listen)
+    apply_sort ();
+
+  if (options.list_data.tree_expanded && !lazy_nodes)
+    gtk_tree_view_expand_all (GTK_TREE_VIEW (list_view));
+
+  if (load_done && options.debug)
+    {
+      gdouble sec = (g_get_monotonic_time () - load_start) / (gdouble) G_USEC_PER_SEC;
+      g_printerr ("yad_list: %lu rows loaded in %.2f sec (%.0f rows/sec)\n",
+                  loaded_rows, sec, sec > 0 ? loaded_rows / sec : (gdouble) loaded_rows);
+    }
+
+  flush_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_row ()
+{
+  if (cur_row == NULL)
+    return;
+
+  if (load_start == 0)
+    load_start = g_get_monotonic_time ();
+
+  g_queue_push_tail (pending_rows, cur_row);
+  cur_row = NULL;
+}
+
+static void
+schedule_flush ()
+{
+  if (flush_id == 0 && !g_queue_is_empty (pending_rows))
+    flush_id = g_idle_add (flush_rows, NULL);
+}
+
+/* parse control line. possible commands are "DEL key" and "SET key column value" */
+static YadListRow *
+parse_control (gchar *str)
+{
+  YadListRow *row = NULL;
+
+  if (g_ascii_strncasecmp (str, "DEL ", 4) == 0)
+    {
+      row = list_row_new ();
+      row->op = LIST_ROW_DEL;
+      row->key = g_strdup (str + 4);
+    }
+  else if (g_ascii_strncasecmp (str, "SET ", 4) == 0)
+    {
+      gchar **args = g_strsplit (str + 4, " ", 3);
+
+      if (args[0] && args[1])
+        {
+          gint col = atoi (args[1]);
+
+          if (col > 0 && col <= n_cols)
+            {
+              row = list_row_new ();
+              row->op = LIST_ROW_SET;
+              row->key = g_strdup (args[0]);
+              row->col = col - 1;
+              row->data[0] = g_strdup (args[2] ? args[2] : "");
+              row->n_data = 1;
+            }
+        }
+      g_strfreev (args);
+    }
+
+  if (row == NULL && options.debug)
+    g_printerr (_("yad_list: invalid control line '%s'\n"), str);
+
+  return row;
+}
+
+static void
+parse_line (gchar *str)
+{
+  /* clear list if ^L received */
+  if (str[0] == '\014')
+    {
+      clear_list ();
+      return;
+    }
+
+  /* control line if ^K received */
+  if (str[0] == '\013')
+    {
+      YadListRow *ctl = parse_control (str + 1);
+      if (ctl)
+        g_queue_push_tail (pending_rows, ctl);
+      return;
+    }
+
+  if (cur_row == NULL)
+    {
+      cur_row = list_row_new ();
+      if (options.list_data.tree_mode)
+        {
+          gchar **ids = g_strsplit (str, ":", 2);
+          cur_row->id = ids[0];
+          cur_row->pid = ids[1];
+          g_free (ids);
+          return;
+        }
+    }
+
+  cur_row->data[cur_row->n_data] = g_strdup (str);
+  cur_row->n_data++;
+  if (cur_row->n_data == n_cols)
+    queue_row ();
+}
+
+static void
+stdin_done (gpointer data)
+{
+  /* add incomplete row */
+  queue_row ();
+  load_done = TRUE;
+  schedule_flush ();
+}
+
+static gboolean
+stdin_record_cb (gchar *str, gsize len, gpointer data)
+{
+  parse_line (str);
+  schedule_flush ();
+  return TRUE;
+}
+
+/* lazy tree loading */
+typedef struct {
+  gchar *id;
+  YadListRow *row;
+} YadTreeLoad;
+
+static void
+tree_load_row (YadTreeLoad *ld)
+{
+  if (ld->row == NULL)
+    return;
+
+  /* node may be removed while loading */
+  if (g_hash_table_contains (row_hash, ld->id))
+    g_queue_push_tail (pending_rows, ld->row);
+  else
+    list_row_free (ld->row);
+  ld->row = NULL;
+}
+
+/* loader output is read in the same way as stdin, so input format and encoding apply to it too */
+static gboolean
+tree_load_record_cb (gchar *str, gsize len, gpointer data)
+{
+  YadTreeLoad *ld = (YadTreeLoad *) data;
+
+  if (ld->row == NULL)
+    {
+      gchar *p = strchr (str, ':');
+
+      if (p)
+        *p = '\0';
+      ld->row = list_row_new ();
+      ld->row->id = g_strdup (str);
+      ld->row->pid = g_strdup (ld->id);
+      return TRUE;
+    }
+
+  ld->row->data[ld->row->n_data] = g_strdup (str);
+  ld->row->n_data++;
+  if (ld->row->n_data == n_cols)
+    {
+      tree_load_row (ld);
+      schedule_flush ();
+    }
+
+  return TRUE;
+}
+
+static void
+tree_load_done (gpointer data)
+{
+  YadTreeLoad *ld = (YadTreeLoad *) data;
+  YadListRow *row;
+
+  /* add incomplete row and mark node as loaded after all its children */
+  tree_load_row (ld);
+  row = list_row_new ();
+  row->op = LIST_ROW_LOADED;
+  row->key = ld->id;
+  g_queue_push_tail (pending_rows, row);
+  schedule_flush ();
+
+  g_free (ld);
+}
+
+static void
+tree_load (const gchar *id)
 {
-  gchar *data = NULL;
-  GtkTreeModel *model = gtk_tree_view_get_model (GTK_TREE_VIEW (list_view));
-  YadColumn *col = (YadColumn *) g_slist_nth_data (options.list_data.columns, num);
+  YadTreeLoad *ld;
+  gchar *qid, *cmd;
+  gint out;
 
-  switch (col->type)
+  qid = g_shell_quote (id);
+  if (g_strstr_len (options.list_data.tree_loader, -1, "%s"))
     {
-    case YAD_COLUMN_CHECK:
-    case YAD_COLUMN_RADIO:
-      {
-        gboolean bval;
-        gtk_tree_model_get (model, it, num, &bval, -1);
-        data = g_strdup (print_bool_val (bval));
-        break;
-      }
-    case YAD_COLUMN_NUM:
-    case YAD_COLUMN_SIZE:
-    case YAD_COLUMN_BAR:
-      {
-        gint64 nval;
-        gtk_tree_model_get (model, it, num, &nval, -1);
-        data = g_strdup_printf ("%ld", (long) nval);
-        break;
-      }
-    case YAD_COLUMN_FLOAT:
-      {
-        gdouble nval;
-        gtk_tree_model_get (model, it, num, &nval, -1);
-        data = g_strdup_printf ("%lf", nval);
-        break;
-      }
-    case YAD_COLUMN_IMAGE:
-      {
-        data = g_strdup ("''");
-        break;
-      }
-    default:
-      {
-        gchar *cval;
-        gtk_tree_model_get (model, it, num, &cval, -1);
-        if (cval)
-          data = g_shell_quote (cval);
-        break;
-      }
+      gchar **parts = g_strsplit (options.list_data.tree_loader, "%s", -1);
+      cmd = g_strjoinv (qid, parts);
+      g_strfreev (parts);
+    }
+  else
+    cmd = g_strdup_printf ("%s %s", options.list_data.tree_loader, qid);
+  g_free (qid);
+
+  if (run_command_pipe (cmd, &out, NULL, NULL) == 0)
+    {
+      g_free (cmd);
+      return;
     }
+  g_free (cmd);
+
+  g_hash_table_add (lazy_loading, g_strdup (id));
+
+  ld = g_new0 (YadTreeLoad, 1);
+  ld->id = g_strdup (id);
 
-  return data;
+  yad_read_records (out, tree_load_record_cb, tree_load_done, ld);
 }
 
-static gboolean
-handle_stdin (GIOChannel *channel, GIOCondition condition, gpointer data)
+static void
+row_expanded_cb (GtkTreeView *view, GtkTreeIter *iter, GtkTreePath *path, gpointer data)
 {
-  static GtkTreeIter iter;
-  static gulong column_count = 0;
-  static gulong row_count = 0;
-  static gboolean node_added = FALSE;
-  GtkTreeModel *model = gtk_tree_view_get_model (GTK_TREE_VIEW (list_view));
-
-  if ((condition == G_IO_IN) || (condition == G_IO_IN + G_IO_HUP))
-    {
-      GError *err = NULL;
-      GString *string = g_string_new (NULL);
+  gchar *id;
 
-      while (channel->is_readable != TRUE)
-        usleep (100);
+  if (!g_hash_table_contains (lazy_nodes, iter->user_data))
+    return;
 
-      do
-        {
-          gint status;
+  id = g_hash_table_lookup (node_ids, iter->user_data);
+  if (id && !g_hash_table_contains (lazy_loading, id))
+    tree_load (id);
+}
 
-          do
-            {
-              status = g_io_channel_read_line_string (channel, string, NULL, &err);
-            }
-          while (status == G_IO_STATUS_AGAIN);
+static void
+row_collapsed_cb (GtkTreeView *view, GtkTreeIter *iter, GtkTreePath *path, gpointer data)
+{
+  GtkTreeIter it = *iter, child;
+  gchar *id = g_hash_table_lookup (node_ids, it.user_data);
 
-          if (status != G_IO_STATUS_NORMAL)
-            {
-              if (err)
-                {
-                  g_printerr ("yad_list_handle_stdin(): %s\n", err->message);
-                  g_error_free (err);
-                  err = NULL;
-                }
-              /* stop handling */
-              g_io_channel_shutdown (channel, TRUE, NULL);
-              return FALSE;
-            }
+  /* node is not loaded yet or still loading */
+  if (id == NULL || g_hash_table_contains (lazy_nodes, it.user_data) ||
+      g_hash_table_contains (lazy_loading, id))
+    return;
 
-          strip_new_line (string->str);
+  while (gtk_tree_model_iter_children (list_model, &child, &it))
+    remove_row (&child);
+  add_placeholder (&it);
+}
 
-          /* clear list if ^L received */
-          if (string->str[0] == '\014')
-            {
-              GtkTreeSelection *sel = gtk_tree_view_get_selection (GTK_TREE_VIEW (list_view));
-              if (select_hndl)
-                g_signal_handler_block (G_OBJECT (sel), select_hndl);
-              gtk_tree_store_clear (GTK_TREE_STORE (model));
-              row_count = column_count = 0;
-              if (row_hash)
-                g_hash_table_remove_all (row_hash);
-              if (select_hndl)
-                g_signal_handler_unblock (G_OBJECT (sel), select_hndl);
-              continue;
-            }
+static void
+read_stdin ()
+{
+  yad_read_records (0, stdin_record_cb, stdin_done, NULL);
+}
 
-          if (row_count == 0 && column_count == 0)
-            {
-              if (options.list_data.tree_mode)
-                {
-                  if (!node_added)
-                    {
-                      gchar **ids = g_strsplit (string->str, ":", 2);
-                      yad_list_add_row (GTK_TREE_STORE (model), &iter, ids[0], ids[1]);
-                      node_added = TRUE;
-                      continue;
-                    }
-                  else
-                    node_added = FALSE;
-                }
-              else
-                yad_list_add_row (GTK_TREE_STORE (model), &iter, NULL, NULL);
-            }
-          else if (column_count == n_cols)
-            {
-              /* We're starting a new row */
-              if (options.list_data.tree_mode)
-                {
-                  if (!node_added)
-                    {
-                      gchar **ids = g_strsplit (string->str, ":", 2);
-                      yad_list_add_row (GTK_TREE_STORE (model), &iter, ids[0], ids[1]);
-                      node_added = TRUE;
-                      continue;
-                    }
-                  else
-                    node_added = FALSE;
-                }
-              else
-                yad_list_add_row (GTK_TREE_STORE (model), &iter, NULL, NULL);
-              column_count = 0;
-              row_count++;
-              if (options.list_data.limit && row_count >= options.list_data.limit)
-                {
-                  gtk_tree_model_get_iter_first (model, &iter);
-                  gtk_tree_store_remove (GTK_TREE_STORE (model), &iter);
-                }
-            }
+/* add rows from --rest file by portions, so rows are never parsed all at once */
+static gboolean
+rest_feed_cb (gpointer data)
+{
+  static guint line = 0;
+  guint n = yad_rest_count ();
 
-          cell_set_data (&iter, column_count, string->str);
-          column_count++;
-        }
-      while (g_io_channel_get_buffer_condition (channel) == G_IO_IN);
-      g_string_free (string, TRUE);
+  while (line < n && g_queue_get_length (pending_rows) < LIST_DETACH_ROWS * 4)
+    {
+      gchar *str = yad_rest_get (line++);
+      parse_line (str);
+      g_free (str);
     }
 
-  if (options.list_data.tree_expanded)
-    gtk_tree_view_expand_all (GTK_TREE_VIEW (list_view));
+  if (line < n)
+    {
+      schedule_flush ();
+      return G_SOURCE_CONTINUE;
+    }
 
-  if ((condition != G_IO_IN) && (condition != G_IO_IN + G_IO_HUP))
+  yad_rest_close ();
+  if (options.common_data.listen)
     {
-      g_io_channel_shutdown (channel, TRUE, NULL);
-      return FALSE;
+      queue_row ();
+      schedule_flush ();
+      read_stdin ();
     }
+  else
+    stdin_done (NULL);
 
-  return TRUE;
+  return G_SOURCE_REMOVE;
 }
 
 static void
 fill_data ()
 {
-  GtkTreeIter iter;
-  GtkTreeStore *model = GTK_TREE_STORE (gtk_tree_view_get_model (GTK_TREE_VIEW (list_view)));
-  GIOChannel *channel;
+  pending_rows = g_queue_new ();
+
+  if (yad_rest_count () > 0)
+    {
+      g_idle_add (rest_feed_cb, NULL);
+      return;
+    }
 
   if (options.extra_data && *options.extra_data)
     {
       gchar **args = options.extra_data;
+      GtkTreeIter iter;
       gint i = 0;
 
-      gtk_widget_freeze_child_notify (list_view);
-
       while (args[i] != NULL)
         {
+          YadListRow *row;
           gint j;
 
+          row = list_row_new ();
           if (options.list_data.tree_mode)
             {
               gchar **ids = g_strsplit (args[i], ":", 2);
-              yad_list_add_row (model, &iter, ids[0], ids[1]);
+              row->id = ids[0];
+              row->pid = ids[1];
+              g_free (ids);
               i++;
             }
-          else
-            yad_list_add_row (model, &iter, NULL, NULL);
           for (j = 0; j < n_cols; j++, i++)
             {
               if (args[i] == NULL)
                 break;
 
-              cell_set_data (&iter, j, args[i]);
+              row->data[j] = g_strdup (args[i]);
+              row->n_data++;
             }
+
+          insert_row (row, &iter);
+          list_row_free (row);
         }
 
-      gtk_widget_thaw_child_notify (list_view);
+      if (row_hash && !options.common_data.listen)
+        flush_orphans ();
+
+      if (options.list_data.fixed_layout)
+        estimate_widths (!options.common_data.listen);
     }
 
   if (options.common_data.listen || !(options.extra_data && *options.extra_data))
-    {
-      channel = g_io_channel_unix_new (0);
-      g_io_channel_set_encoding (channel, NULL, NULL);
-      g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
-      g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, NULL);
-    }
+    read_stdin ();
 }
 
 static gchar *
@@ -767,6 +2251,110 @@ get_data_as_string (GtkTreeIter *iter)
 
 static void edit_row_cb (GtkMenuItem *item, gpointer data);
 
+/* row commands. rows with running command are locked */
+typedef enum {
+  ROW_CMD_UPDATE = 0,
+  ROW_CMD_REMOVE
+} YadRowCmdOp;
+
+typedef struct {
+  GtkTreeRowReference *ref;
+  gpointer lock;
+  YadRowCmdOp op;
+} YadRowCmd;
+
+static GHashTable *locked_rows = NULL;
+
+/* select action scheduler */
+static guint action_timer = 0;
+static GPid action_pid = 0;
+
+/* set row values from the command output */
+static void
+set_row_data (GtkTreeIter *it, gchar *data)
+{
+  gchar **lines;
+  guint i;
+
+  if (data == NULL)
+    return;
+
+  lines = g_strsplit (data, "\n", 0);
+  for (i = 0; i < n_cols; i++)
+    {
+      if (lines[i] == NULL)
+        break;
+
+      cell_set_data (it, i, lines[i]);
+    }
+  g_strfreev (lines);
+}
+
+static gpointer
+row_lock_key (GtkTreeIter *it)
+{
+  if (YAD_IS_LIST_MODEL (list_model))
+    return GUINT_TO_POINTER (yad_list_model_get_row_id (YAD_LIST_MODEL (list_model), it) + 1);
+  return it->user_data;
+}
+
+static gboolean
+row_locked (GtkTreeIter *it)
+{
+  if (locked_rows && g_hash_table_contains (locked_rows, row_lock_key (it)))
+    {
+      if (options.debug)
+        g_printerr (_("yad_list: command for this row is still running\n"));
+      return TRUE;
+    }
+  return FALSE;
+}
+
+static void
+row_cmd_done (gint ret, gchar *out, gpointer data)
+{
+  YadRowCmd *rc = (YadRowCmd *) data;
+  GtkTreePath *path = gtk_tree_row_reference_get_path (rc->ref);
+  GtkTreeIter iter;
+
+  g_hash_table_remove (locked_rows, rc->lock);
+
+  /* row may be removed while command runs */
+  if (path && ret == 0 && gtk_tree_model_get_iter (list_model, &iter, path))
+    {
+      if (rc->op == ROW_CMD_REMOVE)
+        remove_row (&iter);
+      else
+        set_row_data (&iter, out);
+    }
+
+  if (path)
+    gtk_tree_path_free (path);
+  gtk_tree_row_reference_free (rc->ref);
+  g_free (rc);
+}
+
+/* run command for the row in background */
+static void
+run_row_cmd (gchar *cmd, GtkTreeIter *it, YadRowCmdOp op)
+{
+  YadRowCmd *rc;
+  GtkTreePath *path;
+
+  rc = g_new0 (YadRowCmd, 1);
+  path = gtk_tree_model_get_path (list_model, it);
+  rc->ref = gtk_tree_row_reference_new (list_model, path);
+  gtk_tree_path_free (path);
+  rc->lock = row_lock_key (it);
+  rc->op = op;
+
+  if (locked_rows == NULL)
+    locked_rows = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_hash_table_add (locked_rows, rc->lock);
+
+  run_command_cb (cmd, op == ROW_CMD_UPDATE, row_cmd_done, rc);
+}
+
 static void
 double_click_cb (GtkTreeView *view, GtkTreePath *path, GtkTreeViewColumn *column, gpointer d)
 {
@@ -778,9 +2366,16 @@ double_click_cb (GtkTreeView *view, GtkTreePath *path, GtkTreeViewColumn *column
   if (options.list_data.dclick_action)
     {
       gchar *cmd, *args = NULL;
+      gboolean have_row = FALSE;
 
       if (gtk_tree_model_get_iter (model, &iter, path))
-        args = get_data_as_string (&iter);
+        {
+          view_to_list_iter (&iter);
+          if (row_locked (&iter))
+            return;
+          args = get_data_as_string (&iter);
+          have_row = TRUE;
+        }
       else
         args = g_strdup ("");
 
@@ -798,25 +2393,8 @@ double_click_cb (GtkTreeView *view, GtkTreePath *path, GtkTreeViewColumn *column
 
       if (cmd[0] == '@')
         {
-          gchar *data = NULL;
-          gint exit;
-
-          exit = run_command_sync (cmd + 1, &data);
-          if (exit == 0)
-            {
-              gint i;
-              gchar **lines = g_strsplit (data, "\n", 0);
-
-              for (i = 0; i < n_cols; i++)
-                {
-                  if (lines[i] == NULL)
-                    break;
-
-                  cell_set_data (&iter, i, lines[i]);
-                }
-              g_strfreev (lines);
-            }
-          g_free (data);
+          if (have_row)
+            run_row_cmd (cmd + 1, &iter, ROW_CMD_UPDATE);
         }
       else
         run_command_async (cmd);
@@ -835,15 +2413,17 @@ double_click_cb (GtkTreeView *view, GtkTreePath *path, GtkTreeViewColumn *column
 
               gtk_tree_model_get (model, &iter, 0, &chk, -1);
               chk = !chk;
-              gtk_tree_store_set (GTK_TREE_STORE (model), &iter, 0, chk, -1);
+              view_to_list_iter (&iter);
+              list_set (&iter, 0, chk, -1);
             }
         }
       else if (options.list_data.radiobox)
         {
           if (gtk_tree_model_get_iter (model, &iter, path))
             {
-              gtk_tree_model_foreach (model, runtoggle, GINT_TO_POINTER (0));
-              gtk_tree_store_set (GTK_TREE_STORE (model), &iter, 0, TRUE, -1);
+              gtk_tree_model_foreach (list_model, runtoggle, GINT_TO_POINTER (0));
+              view_to_list_iter (&iter);
+              list_set (&iter, 0, TRUE, -1);
             }
         }
       else if (options.plug == -1)
@@ -852,15 +2432,27 @@ double_click_cb (GtkTreeView *view, GtkTreePath *path, GtkTreeViewColumn *column
 }
 
 static void
-select_cb (GtkTreeSelection *sel, gpointer data)
+action_exit_cb (GPid pid, gint status, gpointer data)
+{
+  if (pid == action_pid)
+    action_pid = 0;
+  g_spawn_close_pid (pid);
+}
+
+static gboolean
+select_action_cb (gpointer data)
 {
+  GtkTreeSelection *sel = gtk_tree_view_get_selection (GTK_TREE_VIEW (list_view));
   GtkTreeModel *model;
   GtkTreeIter iter;
   gchar *cmd, *args;
 
+  action_timer = 0;
+
   if (!gtk_tree_selection_get_selected (sel, &model, &iter))
-    return;
+    return G_SOURCE_REMOVE;
 
+  view_to_list_iter (&iter);
   args = get_data_as_string (&iter);
   if (!args)
     args = g_strdup ("");
@@ -877,9 +2469,34 @@ select_cb (GtkTreeSelection *sel, gpointer data)
     cmd = g_strdup_printf ("%s %s", options.list_data.select_action, args);
   g_free (args);
 
-  run_command_async (cmd);
+  if (options.list_data.action_delay > 0)
+    {
+      /* result of previous action is out of date. terminate the whole group,
+         because the action may be a shell with its own children */
+      if (action_pid)
+        kill (-action_pid, SIGTERM);
+      action_pid = run_command_group (cmd, NULL, action_exit_cb, NULL);
+    }
+  else
+    run_command_async (cmd);
 
   g_free (cmd);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+select_cb (GtkTreeSelection *sel, gpointer data)
+{
+  /* run action only when selection is settled */
+  if (action_timer)
+    g_source_remove (action_timer);
+  action_timer = 0;
+
+  if (options.list_data.action_delay > 0)
+    action_timer = g_timeout_add (options.list_data.action_delay, select_action_cb, NULL);
+  else
+    select_action_cb (NULL);
 }
 
 static void
@@ -905,36 +2522,14 @@ add_row_cb (GtkMenuItem *item, gpointer data)
 
   if (options.list_data.row_action)
     {
-      gchar *out = NULL;
-      gint exit;
-
       /* hide menu first */
       if (data)
-        {
-          gtk_menu_popdown (GTK_MENU (data));
-          while (gtk_events_pending ())
-            gtk_main_iteration ();
-        }
+        gtk_menu_popdown (GTK_MENU (data));
 
       /* run command */
       cmd = g_strdup_printf ("%s add", options.list_data.row_action);
-      exit = run_command_sync (cmd, &out);
+      run_row_cmd (cmd, &iter, ROW_CMD_UPDATE);
       g_free (cmd);
-      if (exit == 0)
-        {
-          guint i;
-          gchar **lines = g_strsplit (out, "\n", 0);
-
-          for (i = 0; i < n_cols; i++)
-            {
-              if (lines[i] == NULL)
-                break;
-
-              cell_set_data (&iter, i, lines[i]);
-            }
-          g_strfreev (lines);
-        }
-      g_free (out);
     }
 }
 
@@ -947,40 +2542,24 @@ edit_row_cb (GtkMenuItem *item, gpointer data)
   if (!gtk_tree_selection_get_selected (sel, NULL, &iter))
     return;
 
+  view_to_list_iter (&iter);
+  if (row_locked (&iter))
+    return;
+
   if (options.list_data.row_action)
     {
-      gchar *cmd, *args, *out = NULL;
-      gint exit;
+      gchar *cmd, *args;
 
       /* hide menu first */
       if (data)
-        {
-          gtk_menu_popdown (GTK_MENU (data));
-          while (gtk_events_pending ())
-            gtk_main_iteration ();
-        }
+        gtk_menu_popdown (GTK_MENU (data));
 
       /* run command */
       args = get_data_as_string (&iter);
       cmd = g_strdup_printf ("%s edit %s", options.list_data.row_action, args);
       g_free (args);
-      exit = run_command_sync (cmd, &out);
+      run_row_cmd (cmd, &iter, ROW_CMD_UPDATE);
       g_free (cmd);
-      if (exit == 0)
-        {
-          guint i;
-          gchar **lines = g_strsplit (out, "\n", 0);
-
-          for (i = 0; i < n_cols; i++)
-            {
-              if (lines[i] == NULL)
-                break;
-
-              cell_set_data (&iter, i, lines[i]);
-            }
-          g_strfreev (lines);
-        }
-      g_free (out);
     }
 }
 
@@ -988,32 +2567,30 @@ static void
 del_row_cb (GtkMenuItem *item, gpointer data)
 {
   GtkTreeIter iter;
-  GtkTreeModel *model = gtk_tree_view_get_model (GTK_TREE_VIEW (list_view));
   GtkTreeSelection *sel = gtk_tree_view_get_selection (GTK_TREE_VIEW (list_view));
 
   if (gtk_tree_selection_get_selected (sel, NULL, &iter))
     {
+      view_to_list_iter (&iter);
+      if (row_locked (&iter))
+        return;
+
       if (options.list_data.row_action)
         {
           gchar *cmd, *args;
-          gint exit;
 
           /* hide menu first */
           gtk_menu_popdown (GTK_MENU (data));
-          while (gtk_events_pending ())
-            gtk_main_iteration ();
 
           /* run command */
           args = get_data_as_string (&iter);
           cmd = g_strdup_printf ("%s del %s", options.list_data.row_action, args);
           g_free (args);
-          exit = run_command_sync (cmd, NULL);
+          run_row_cmd (cmd, &iter, ROW_CMD_REMOVE);
           g_free (cmd);
-          if (exit == 0)
-            gtk_tree_store_remove (GTK_TREE_STORE (model), &iter);
         }
       else
-        gtk_tree_store_remove (GTK_TREE_STORE (model), &iter);
+        remove_row (&iter);
     }
 }
 
@@ -1041,7 +2618,7 @@ copy_row_cb (GtkMenuItem *item, gpointer data)
           gint64 iv;
           gfloat fv;
           gboolean bv;
-          YadColumn *col = (YadColumn *) g_slist_nth_data (options.list_data.columns, i);
+          YadColumn *col = schema[i].col;
 
           switch (col->type)
             {
@@ -1222,8 +2799,13 @@ parse_cols_props ()
         }
     }
 
-  /* set wrap property for columns */
-  if (options.list_data.wrap_width > 0)
+  /* set wrap property for columns. wrapped rows can't have fixed height */
+  if (options.list_data.fixed_layout && options.list_data.wrap_width > 0)
+    {
+      if (options.debug)
+        g_printerr (_("WARNING: --wrap-width is ignored with --fixed-layout\n"));
+    }
+  else if (options.list_data.wrap_width > 0)
     {
       if (options.list_data.wrap_cols)
         {
@@ -1288,6 +2870,21 @@ parse_cols_props ()
         }
     }
 
+  /* set widths for fixed layout */
+  if (options.list_data.fixed_layout && options.list_data.col_widths)
+    {
+      gchar **wstr = g_strsplit (options.list_data.col_widths, ",", -1);
+
+      i = 0;
+      for (c = options.list_data.columns; c && wstr[i]; c = c->next)
+        {
+          YadColumn *col = (YadColumn *) c->data;
+          col->width = atoi (wstr[i]);
+          i++;
+        }
+      g_strfreev (wstr);
+    }
+
   /* set alignment */
   i = 0;
   for (c = options.list_data.columns; c; c = c->next)
@@ -1351,7 +2948,16 @@ list_create_widget (GtkWidget *dlg)
     }
 
   if (options.list_data.tree_mode)
-    row_hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) gtk_tree_path_free);
+    {
+      row_hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) gtk_tree_iter_free);
+      node_ids = g_hash_table_new (g_direct_hash, g_direct_equal);
+      orphans = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) free_orphans);
+      if (options.list_data.tree_loader)
+        {
+          lazy_nodes = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) gtk_tree_iter_free);
+          lazy_loading = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        }
+    }
 
   /* set normalized alignment array for list keaders and columns content */
   if (options.list_data.col_align)
@@ -1372,14 +2978,44 @@ list_create_widget (GtkWidget *dlg)
   gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (w), GTK_SHADOW_ETCHED_IN);
   gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (w), options.data.hscroll_policy, options.data.vscroll_policy);
 
-  model = create_model ();
+  /* keep own reference to the model, because it may be temporary detached from view */
+  list_model = model = create_model ();
+
+  /* key index needs persistent rows, so it works only with flat model */
+  if (options.list_data.key_column > 0 && options.list_data.key_column <= n_cols)
+    {
+      if (YAD_IS_LIST_MODEL (model))
+        {
+          key_col = options.list_data.key_column - 1;
+          key_hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) gtk_tree_iter_free);
+        }
+      else if (options.debug)
+        g_printerr (_("WARNING: --key-column is ignored in tree mode and for editable lists\n"));
+    }
+
+  /* live filter needs stable row ids, so it works only with flat model too */
+  if (options.list_data.live_filter)
+    {
+      if (YAD_IS_LIST_MODEL (model))
+        {
+          /* must be connected before filter model, so the rows are checked before it sees them */
+          g_signal_connect (G_OBJECT (model), "row-inserted", G_CALLBACK (filter_row_cb), NULL);
+          g_signal_connect (G_OBJECT (model), "row-changed", G_CALLBACK (filter_row_cb), NULL);
+
+          filter_model = gtk_tree_model_filter_new (model, NULL);
+          gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter_model),
+                                                  filter_visible_func, NULL, NULL);
+          filter_dirty = g_hash_table_new (g_direct_hash, g_direct_equal);
+        }
+      else if (options.debug)
+        g_printerr (_("WARNING: --live-filter is ignored in tree mode and for editable lists\n"));
+    }
 
-  list_view = gtk_tree_view_new_with_model (model);
+  list_view = gtk_tree_view_new_with_model (filter_model ? filter_model : model);
   gtk_widget_set_name (list_view, "yad-list-widget");
   gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (list_view), !options.list_data.no_headers);
   gtk_tree_view_set_grid_lines (GTK_TREE_VIEW (list_view), options.list_data.grid_lines);
   gtk_tree_view_set_reorderable (GTK_TREE_VIEW (list_view), options.common_data.editable);
-  g_object_unref (model);
 
   gtk_container_add (GTK_CONTAINER (w), list_view);
 
@@ -1402,10 +3038,10 @@ list_create_widget (GtkWidget *dlg)
     }
 
   /* set search function for regex search */
-  if (options.list_data.search_column != -1 && options.list_data.regex_search)
+  if (options.list_data.search_column >= 0 && options.list_data.search_column < (gint) n_cols &&
+      options.list_data.regex_search && !filter_model)
     {
-      YadColumn *col = (YadColumn *) g_slist_nth_data (options.list_data.columns,
-                                                       options.list_data.search_column);
+      YadColumn *col = schema[options.list_data.search_column].col;
 
       if (col->type == YAD_COLUMN_TEXT)
         gtk_tree_view_set_search_equal_func (GTK_TREE_VIEW (list_view), regex_search, NULL, NULL);
@@ -1435,79 +3071,71 @@ list_create_widget (GtkWidget *dlg)
       g_signal_connect (G_OBJECT (list_view), "key-press-event", G_CALLBACK (list_activate_cb), dlg);
     }
 
+  if (lazy_nodes)
+    {
+      g_signal_connect (G_OBJECT (list_view), "row-expanded", G_CALLBACK (row_expanded_cb), NULL);
+      if (options.list_data.tree_unload)
+        g_signal_connect (G_OBJECT (list_view), "row-collapsed", G_CALLBACK (row_collapsed_cb), NULL);
+    }
+
   /* load data */
   fill_data ();
+  if (options.extra_data && *options.extra_data && !options.common_data.listen)
+    apply_sort ();
 
-  if (options.list_data.tree_expanded)
+  if (options.list_data.tree_expanded && !lazy_nodes)
     gtk_tree_view_expand_all (GTK_TREE_VIEW (list_view));
 
+  if (filter_model)
+    {
+      gint i;
+
+      /* filter by search column or by the first text column */
+      filter_col = options.list_data.search_column;
+      if (filter_col < 0 || filter_col >= (gint) n_cols || schema[filter_col].col->type != YAD_COLUMN_TEXT)
+        {
+          filter_col = -1;
+          for (i = 0; i < n_cols; i++)
+            {
+              if (schema[i].col->type == YAD_COLUMN_TEXT)
+                {
+                  filter_col = i;
+                  break;
+                }
+            }
+        }
+
+      if (filter_col != -1)
+        {
+          GtkWidget *box, *entry;
+
+          box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 2);
+
+          entry = gtk_search_entry_new ();
+          gtk_widget_set_name (entry, "yad-list-filter");
+          g_signal_connect (G_OBJECT (entry), "search-changed", G_CALLBACK (filter_changed_cb), NULL);
+          gtk_box_pack_start (GTK_BOX (box), entry, FALSE, FALSE, 0);
+          gtk_box_pack_start (GTK_BOX (box), w, TRUE, TRUE, 0);
+
+          /* filter entry replaces interactive search */
+          gtk_tree_view_set_enable_search (GTK_TREE_VIEW (list_view), FALSE);
+          g_signal_connect (G_OBJECT (list_view), "key-press-event", G_CALLBACK (filter_key_cb), entry);
+
+          w = box;
+        }
+    }
+
   return w;
 }
 
 static void
 print_col (GtkTreeModel *model, GtkTreeIter *iter, gint num)
 {
-  YadColumn *col = (YadColumn *) g_slist_nth_data (options.list_data.columns, num);
-
   /* don't print attributes */
-  if (col->type == YAD_COLUMN_ATTR_FORE || col->type == YAD_COLUMN_ATTR_BACK || col->type == YAD_COLUMN_ATTR_FONT)
+  if (schema[num].print == NULL)
     return;
 
-  switch (col->type)
-    {
-    case YAD_COLUMN_CHECK:
-    case YAD_COLUMN_RADIO:
-      {
-        gboolean bval;
-        gtk_tree_model_get (model, iter, num, &bval, -1);
-        if (options.common_data.quoted_output)
-          g_printf ("'%s'", print_bool_val (bval));
-        else
-          g_printf ("%s", print_bool_val (bval));
-        break;
-      }
-    case YAD_COLUMN_NUM:
-    case YAD_COLUMN_SIZE:
-    case YAD_COLUMN_BAR:
-      {
-        gint64 nval;
-        gtk_tree_model_get (model, iter, num, &nval, -1);
-        if (options.common_data.quoted_output)
-          g_printf ("'%ld'", (long) nval);
-        else
-          g_printf ("%ld", (long) nval);
-        break;
-      }
-    case YAD_COLUMN_FLOAT:
-      {
-        gdouble nval;
-        gtk_tree_model_get (model, iter, num, &nval, -1);
-        if (options.common_data.quoted_output)
-          g_printf ("'%.*f'", options.common_data.float_precision, nval);
-        else
-          g_printf ("%.*f", options.common_data.float_precision, nval);
-        break;
-      }
-    case YAD_COLUMN_IMAGE:
-      if (options.common_data.quoted_output)
-        g_printf ("''");
-      break;
-    default:
-      {
-        gchar *val;
-        gtk_tree_model_get (model, iter, num, &val, -1);
-        if (options.common_data.quoted_output)
-          {
-            gchar *buf = g_shell_quote (val ? val : "");
-            g_printf ("%s", buf);
-            g_free (buf);
-          }
-        else
-          g_printf ("%s", val ? val : "");
-        break;
-      }
-    }
-  g_printf ("%s", options.common_data.separator);
+  schema[num].print (model, iter, num);
 }
 
 static void
@@ -1515,6 +3143,9 @@ print_selected (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpoin
 {
   gint i,col;
 
+  if (is_placeholder (iter))
+    return;
+
   col = options.list_data.print_column;
 
   if (col && col <= n_cols)
@@ -1524,7 +3155,7 @@ print_selected (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpoin
       for (i = 0; i < n_cols; i++)
         print_col (model, iter, i);
     }
-  g_printf ("\n");
+  yad_output_row_end (TRUE);
 }
 
 static void
@@ -1537,9 +3168,11 @@ print_all (GtkTreeModel *model, GtkTreeIter *parent)
     {
       do
         {
+          if (is_placeholder (&iter))
+            continue;
           for (i = 0; i < n_cols; i++)
             print_col (model, &iter, i);
-          g_printf ("\n");
+          yad_output_row_end (TRUE);
           /* print children */
           print_all (model, &iter);
         }
@@ -1553,7 +3186,7 @@ list_print_result (void)
   GtkTreeModel *model;
   gint col = options.list_data.print_column;
 
-  model = gtk_tree_view_get_model (GTK_TREE_VIEW (list_view));
+  model = list_model;
 
   if (options.list_data.print_all)
     {
@@ -1577,7 +3210,7 @@ list_print_result (void)
                   if (chk)
                     {
                       print_col (model, &iter, col - 1);
-                      g_printf ("\n");
+                      yad_output_row_end (TRUE);
                     }
                 }
               while (gtk_tree_model_iter_next (model, &iter));
@@ -1598,7 +3231,7 @@ list_print_result (void)
                       gint i;
                       for (i = 0; i < n_cols; i++)
                         print_col (model, &iter, i);
-                      g_printf ("\n");
+                      yad_output_row_end (TRUE);
                     }
                 }
               while (gtk_tree_model_iter_next (model, &iter));
@@ -0,0 +1,1461 @@
+/*
+ * This file is part of YAD.
+ *
+ * YAD is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YAD. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2008-2025, Victor Ananjevsky <victor@sanana.kiev.ua>
+ */
+
+/*
+ * Rows are kept in slots. Each column is a plain array of cells indexed by slot,
+ * all strings are interned into one string chunk. Slot of the row never changes,
+ * so iterators are persistent. Order of rows is a ring of slots, and each slot
+ * remembers its sequence number, so adding or removing rows on both ends of the
+ * list and getting row position are done in constant time. Slots of removed rows
+ * are reused, and the string chunk is compacted when most of it is garbage.
+ */
+
+#include <string.h>
+
+#include <gobject/gvaluecollector.h>
+
+#include "listmodel.h"
+
+#define STRING_CHUNK_SIZE 65536
+/* don't compact strings smaller than this */
+#define COMPACT_MIN_SIZE (4 * STRING_CHUNK_SIZE)
+#define MIN_SLOTS 256
+/* don't split sorting between threads for less rows than this */
+#define SORT_CHUNK_MIN 16384
+
+typedef union {
+  const gchar *s;
+  gint64 i;
+  gdouble d;
+  gboolean b;
+  gpointer o;
+} YadListCell;
+
+typedef struct {
+  GtkTreeIterCompareFunc func;
+  gpointer data;
+  GDestroyNotify destroy;
+} YadListSortFunc;
+
+typedef struct {
+  gint column;
+  GtkSortType order;
+} YadListSortKey;
+
+struct _YadListModel {
+  GObject parent;
+
+  gint stamp;
+
+  gint n_columns;
+  GType *types;
+  YadListCell **cells;
+  /* collation keys of string columns used in sorting */
+  gchar ***keys;
+
+  GStringChunk *strings;
+  GHashTable *interned;
+  gsize chunk_bytes;
+  gsize live_bytes;
+
+  /* slots */
+  guint n_slots;
+  guint slots_size;
+  gint64 *seq;
+  GArray *free_slots;
+
+  /* rows order */
+  guint *order;
+  guint order_size;
+  guint head;
+  guint n_rows;
+  gint64 first_seq;
+
+  /* sorting */
+  gint sort_column_id;
+  GtkSortType sort_order;
+  YadListSortFunc *sort_funcs;
+  YadListSortFunc default_sort;
+  /* full sort spec. first key is the sort column */
+  YadListSortKey *sort_keys;
+  gint n_sort_keys;
+};
+
+/* parallel sorting */
+typedef struct _YadSortJob YadSortJob;
+
+struct _YadSortJob {
+  void (*func) (YadSortJob *job);
+  YadListModel *model;
+  guint *src;
+  guint *dst;
+  guint n1, n2;
+  gint column;
+};
+
+static GThreadPool *sort_pool = NULL;
+static GMutex sort_lock;
+static GCond sort_cond;
+static guint sort_pending = 0;
+
+static void yad_list_model_tree_model_init (GtkTreeModelIface *iface);
+static void yad_list_model_sortable_init (GtkTreeSortableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (YadListModel, yad_list_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL, yad_list_model_tree_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_SORTABLE, yad_list_model_sortable_init))
+
+static inline guint
+row_slot (YadListModel *model, guint pos)
+{
+  return model->order[(model->head + pos) % model->order_size];
+}
+
+static inline guint
+slot_pos (YadListModel *model, guint slot)
+{
+  return (guint) (model->seq[slot] - model->first_seq);
+}
+
+static inline gboolean
+iter_is_valid (YadListModel *model, GtkTreeIter *iter)
+{
+  return (iter != NULL && iter->stamp == model->stamp &&
+          GPOINTER_TO_UINT (iter->user_data) < model->n_slots);
+}
+
+static inline void
+set_iter (YadListModel *model, GtkTreeIter *iter, guint slot)
+{
+  iter->stamp = model->stamp;
+  iter->user_data = GUINT_TO_POINTER (slot);
+  iter->user_data2 = iter->user_data3 = NULL;
+}
+
+/* strings */
+
+static const gchar *
+intern_string (YadListModel *model, const gchar *str)
+{
+  gchar *s = g_hash_table_lookup (model->interned, str);
+
+  if (s == NULL)
+    {
+      s = g_string_chunk_insert (model->strings, str);
+      g_hash_table_add (model->interned, s);
+      model->chunk_bytes += strlen (s) + 1;
+    }
+
+  return s;
+}
+
+/* move all live strings to the new chunk */
+static void
+compact_strings (YadListModel *model)
+{
+  GStringChunk *old = model->strings;
+  gint i;
+  guint j;
+
+  model->strings = g_string_chunk_new (STRING_CHUNK_SIZE);
+  g_hash_table_remove_all (model->interned);
+  model->chunk_bytes = 0;
+
+  for (i = 0; i < model->n_columns; i++)
+    {
+      if (G_TYPE_FUNDAMENTAL (model->types[i]) != G_TYPE_STRING)
+        continue;
+
+      for (j = 0; j < model->n_rows; j++)
+        {
+          YadListCell *cell = &model->cells[i][row_slot (model, j)];
+          if (cell->s)
+            cell->s = intern_string (model, cell->s);
+        }
+    }
+
+  g_string_chunk_free (old);
+}
+
+static inline void
+maybe_compact (YadListModel *model)
+{
+  if (model->chunk_bytes > COMPACT_MIN_SIZE && model->chunk_bytes > 2 * model->live_bytes)
+    compact_strings (model);
+}
+
+/* slots management */
+
+static guint
+alloc_slot (YadListModel *model)
+{
+  guint slot;
+  gint i;
+
+  if (model->free_slots->len > 0)
+    {
+      slot = g_array_index (model->free_slots, guint, model->free_slots->len - 1);
+      g_array_set_size (model->free_slots, model->free_slots->len - 1);
+    }
+  else
+    {
+      if (model->n_slots == model->slots_size)
+        {
+          model->slots_size = MAX (model->slots_size * 2, MIN_SLOTS);
+          for (i = 0; i < model->n_columns; i++)
+            {
+              model->cells[i] = g_renew (YadListCell, model->cells[i], model->slots_size);
+              if (model->keys[i])
+                model->keys[i] = g_renew (gchar *, model->keys[i], model->slots_size);
+            }
+          model->seq = g_renew (gint64, model->seq, model->slots_size);
+        }
+      slot = model->n_slots++;
+    }
+
+  for (i = 0; i < model->n_columns; i++)
+    {
+      memset (&model->cells[i][slot], 0, sizeof (YadListCell));
+      if (model->keys[i])
+        model->keys[i][slot] = NULL;
+    }
+
+  return slot;
+}
+
+static void
+free_slot (YadListModel *model, guint slot)
+{
+  gint i;
+
+  /* strings stays in the chunk until compaction */
+  for (i = 0; i < model->n_columns; i++)
+    {
+      YadListCell *cell = &model->cells[i][slot];
+
+      if (G_TYPE_IS_OBJECT (model->types[i]) && cell->o)
+        g_object_unref (cell->o);
+      else if (G_TYPE_FUNDAMENTAL (model->types[i]) == G_TYPE_STRING && cell->s)
+        model->live_bytes -= strlen (cell->s) + 1;
+
+      if (model->keys[i])
+        {
+          g_free (model->keys[i][slot]);
+          model->keys[i][slot] = NULL;
+        }
+    }
+
+  g_array_append_val (model->free_slots, slot);
+}
+
+/* rows order management */
+
+static void
+insert_slot (YadListModel *model, guint pos, guint slot)
+{
+  guint i;
+
+  if (model->n_rows == model->order_size)
+    {
+      guint size = MAX (model->order_size * 2, MIN_SLOTS);
+      guint *order = g_new (guint, size);
+
+      for (i = 0; i < model->n_rows; i++)
+        order[i] = row_slot (model, i);
+      g_free (model->order);
+      model->order = order;
+      model->order_size = size;
+      model->head = 0;
+    }
+
+  if (pos == model->n_rows)
+    {
+      model->order[(model->head + pos) % model->order_size] = slot;
+      model->seq[slot] = model->first_seq + pos;
+    }
+  else if (pos == 0)
+    {
+      model->head = (model->head + model->order_size - 1) % model->order_size;
+      model->first_seq--;
+      model->order[model->head] = slot;
+      model->seq[slot] = model->first_seq;
+    }
+  else
+    {
+      for (i = model->n_rows; i > pos; i--)
+        {
+          guint s = row_slot (model, i - 1);
+          model->order[(model->head + i) % model->order_size] = s;
+          model->seq[s]++;
+        }
+      model->order[(model->head + pos) % model->order_size] = slot;
+      model->seq[slot] = model->first_seq + pos;
+    }
+
+  model->n_rows++;
+}
+
+static void
+remove_pos (YadListModel *model, guint pos)
+{
+  guint i;
+
+  if (pos == 0)
+    {
+      model->head = (model->head + 1) % model->order_size;
+      model->first_seq++;
+    }
+  else
+    {
+      for (i = pos; i < model->n_rows - 1; i++)
+        {
+          guint s = row_slot (model, i + 1);
+          model->order[(model->head + i) % model->order_size] = s;
+          model->seq[s]--;
+        }
+    }
+
+  model->n_rows--;
+}
+
+/* cells */
+
+/* returns TRUE if cell value was changed */
+static gboolean
+set_cell (YadListModel *model, guint slot, gint column, const GValue *value)
+{
+  YadListCell *cell = &model->cells[column][slot];
+  GType type = model->types[column];
+  GValue tmp = G_VALUE_INIT;
+  gboolean changed = TRUE;
+
+  if (!g_type_is_a (G_VALUE_TYPE (value), type))
+    {
+      g_value_init (&tmp, type);
+      if (!g_value_transform (value, &tmp))
+        {
+          g_warning ("Unable to convert from %s to %s", g_type_name (G_VALUE_TYPE (value)), g_type_name (type));
+          g_value_unset (&tmp);
+          return FALSE;
+        }
+      value = &tmp;
+    }
+
+  switch (G_TYPE_FUNDAMENTAL (type))
+    {
+    case G_TYPE_STRING:
+      {
+        const gchar *str = g_value_get_string (value);
+        if (g_strcmp0 (cell->s, str) == 0)
+          changed = FALSE;
+        else
+          {
+            if (cell->s)
+              model->live_bytes -= strlen (cell->s) + 1;
+            cell->s = str ? intern_string (model, str) : NULL;
+            if (cell->s)
+              model->live_bytes += strlen (cell->s) + 1;
+            if (model->keys[column])
+              {
+                g_free (model->keys[column][slot]);
+                model->keys[column][slot] = str ? g_utf8_collate_key (str, -1) : NULL;
+              }
+          }
+        break;
+      }
+    case G_TYPE_INT64:
+      changed = (cell->i != g_value_get_int64 (value));
+      cell->i = g_value_get_int64 (value);
+      break;
+    case G_TYPE_DOUBLE:
+      changed = (cell->d != g_value_get_double (value));
+      cell->d = g_value_get_double (value);
+      break;
+    case G_TYPE_BOOLEAN:
+      changed = (!cell->b != !g_value_get_boolean (value));
+      cell->b = g_value_get_boolean (value);
+      break;
+    case G_TYPE_OBJECT:
+      if (cell->o == g_value_get_object (value))
+        changed = FALSE;
+      else
+        {
+          if (cell->o)
+            g_object_unref (cell->o);
+          cell->o = g_value_dup_object (value);
+        }
+      break;
+    default:
+      g_warning ("Unsupported column type %s", g_type_name (type));
+      changed = FALSE;
+      break;
+    }
+
+  if (value == &tmp)
+    g_value_unset (&tmp);
+
+  return changed;
+}
+
+static gint
+compare_cells (YadListModel *model, gint column, guint a, guint b)
+{
+  YadListCell *ca = &model->cells[column][a];
+  YadListCell *cb = &model->cells[column][b];
+
+  switch (G_TYPE_FUNDAMENTAL (model->types[column]))
+    {
+    case G_TYPE_STRING:
+      if (ca->s == cb->s)
+        return 0;
+      if (ca->s == NULL)
+        return -1;
+      if (cb->s == NULL)
+        return 1;
+      if (model->keys[column])
+        return strcmp (model->keys[column][a], model->keys[column][b]);
+      return g_utf8_collate (ca->s, cb->s);
+    case G_TYPE_INT64:
+      return (ca->i > cb->i) - (ca->i < cb->i);
+    case G_TYPE_DOUBLE:
+      return (ca->d > cb->d) - (ca->d < cb->d);
+    case G_TYPE_BOOLEAN:
+      return (!!ca->b) - (!!cb->b);
+    default:
+      return 0;
+    }
+}
+
+/* sorting */
+
+static inline gboolean
+is_sorted (YadListModel *model)
+{
+  return (model->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID);
+}
+
+/* check if changing of the column may move the row. custom compare functions
+   may look at any column, so every change counts for them */
+static gboolean
+sorted_by (YadListModel *model, gint column)
+{
+  gint i;
+
+  if (!is_sorted (model))
+    return FALSE;
+
+  if (model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID ||
+      model->sort_funcs[model->sort_column_id].func != NULL)
+    return TRUE;
+
+  for (i = 0; i < model->n_sort_keys; i++)
+    {
+      if (model->sort_keys[i].column == column)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gint
+compare_slots (gconstpointer a, gconstpointer b, gpointer data)
+{
+  YadListModel *model = (YadListModel *) data;
+  guint sa = *((guint *) a);
+  guint sb = *((guint *) b);
+  YadListSortFunc *sf;
+  gint ret;
+
+  if (model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    sf = &model->default_sort;
+  else
+    sf = &model->sort_funcs[model->sort_column_id];
+
+  if (sf->func)
+    {
+      GtkTreeIter ia, ib;
+
+      set_iter (model, &ia, sa);
+      set_iter (model, &ib, sb);
+      ret = sf->func (GTK_TREE_MODEL (model), &ia, &ib, sf->data);
+    }
+  else
+    {
+      gint i;
+
+      /* next keys are used only if previous are equal */
+      for (i = 0; i < model->n_sort_keys; i++)
+        {
+          ret = compare_cells (model, model->sort_keys[i].column, sa, sb);
+          if (ret != 0)
+            return (model->sort_keys[i].order == GTK_SORT_DESCENDING) ? -ret : ret;
+        }
+      return 0;
+    }
+
+  if (model->sort_order == GTK_SORT_DESCENDING)
+    ret = -ret;
+
+  return ret;
+}
+
+static void
+sort_pool_func (gpointer data, gpointer user_data)
+{
+  YadSortJob *job = (YadSortJob *) data;
+
+  job->func (job);
+
+  g_mutex_lock (&sort_lock);
+  if (--sort_pending == 0)
+    g_cond_signal (&sort_cond);
+  g_mutex_unlock (&sort_lock);
+}
+
+/* run jobs in thread pool and wait for all of them */
+static void
+run_jobs (YadSortJob *jobs, guint n_jobs)
+{
+  guint i;
+
+  if (n_jobs == 1)
+    {
+      jobs[0].func (&jobs[0]);
+      return;
+    }
+
+  if (sort_pool == NULL)
+    sort_pool = g_thread_pool_new (sort_pool_func, NULL, g_get_num_processors (), FALSE, NULL);
+
+  sort_pending = n_jobs;
+  for (i = 0; i < n_jobs; i++)
+    g_thread_pool_push (sort_pool, &jobs[i], NULL);
+
+  g_mutex_lock (&sort_lock);
+  while (sort_pending > 0)
+    g_cond_wait (&sort_cond, &sort_lock);
+  g_mutex_unlock (&sort_lock);
+}
+
+static guint
+n_sort_jobs (guint n)
+{
+  return CLAMP (n / SORT_CHUNK_MIN, 1, g_get_num_processors ());
+}
+
+static void
+keys_job (YadSortJob *job)
+{
+  YadListModel *model = job->model;
+  guint i;
+
+  for (i = 0; i < job->n1; i++)
+    {
+      guint slot = job->src[i];
+      const gchar *str = model->cells[job->column][slot].s;
+
+      model->keys[job->column][slot] = str ? g_utf8_collate_key (str, -1) : NULL;
+    }
+}
+
+/* collation keys are computed once for all rows, and then on each change */
+static void
+ensure_keys (YadListModel *model, gint column, guint *slots)
+{
+  YadSortJob *jobs;
+  guint i, n_jobs;
+
+  if (model->keys[column] || G_TYPE_FUNDAMENTAL (model->types[column]) != G_TYPE_STRING)
+    return;
+
+  model->keys[column] = g_new0 (gchar *, MAX (model->slots_size, 1));
+  if (model->n_rows == 0)
+    return;
+
+  n_jobs = n_sort_jobs (model->n_rows);
+  jobs = g_new0 (YadSortJob, n_jobs);
+  for (i = 0; i < n_jobs; i++)
+    {
+      guint start = (guint64) model->n_rows * i / n_jobs;
+      guint end = (guint64) model->n_rows * (i + 1) / n_jobs;
+
+      jobs[i].func = keys_job;
+      jobs[i].model = model;
+      jobs[i].column = column;
+      jobs[i].src = slots + start;
+      jobs[i].n1 = end - start;
+    }
+  run_jobs (jobs, n_jobs);
+  g_free (jobs);
+}
+
+static void
+sort_job (YadSortJob *job)
+{
+  g_qsort_with_data (job->src, job->n1, sizeof (guint), compare_slots, job->model);
+}
+
+/* stable merge of two adjacent runs */
+static void
+merge_job (YadSortJob *job)
+{
+  guint *a = job->src, *b = job->src + job->n1;
+  guint *ae = b, *be = b + job->n2;
+  guint *d = job->dst;
+
+  while (a < ae && b < be)
+    {
+      if (compare_slots (b, a, job->model) < 0)
+        *d++ = *b++;
+      else
+        *d++ = *a++;
+    }
+  while (a < ae)
+    *d++ = *a++;
+  while (b < be)
+    *d++ = *b++;
+}
+
+/* sort chunks in parallel and merge them pairwise. returns sorted array,
+   which may be different from slots. the other one is freed */
+static guint *
+sort_slots (YadListModel *model, guint *slots, guint n)
+{
+  YadSortJob *jobs;
+  guint *bounds, *src, *dst;
+  guint i, n_runs;
+
+  /* user compare functions may be not thread safe */
+  if (model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID ||
+      model->sort_funcs[model->sort_column_id].func != NULL)
+    n_runs = 1;
+  else
+    n_runs = n_sort_jobs (n);
+
+  if (n_runs == 1)
+    {
+      g_qsort_with_data (slots, n, sizeof (guint), compare_slots, model);
+      return slots;
+    }
+
+  jobs = g_new0 (YadSortJob, n_runs);
+  bounds = g_new (guint, n_runs + 1);
+  for (i = 0; i <= n_runs; i++)
+    bounds[i] = (guint64) n * i / n_runs;
+
+  for (i = 0; i < n_runs; i++)
+    {
+      jobs[i].func = sort_job;
+      jobs[i].model = model;
+      jobs[i].src = slots + bounds[i];
+      jobs[i].n1 = bounds[i + 1] - bounds[i];
+    }
+  run_jobs (jobs, n_runs);
+
+  src = slots;
+  dst = g_new (guint, n);
+  while (n_runs > 1)
+    {
+      guint *tmp, n_jobs = 0, k;
+
+      for (i = 0; i + 1 < n_runs; i += 2)
+        {
+          jobs[n_jobs].func = merge_job;
+          jobs[n_jobs].model = model;
+          jobs[n_jobs].src = src + bounds[i];
+          jobs[n_jobs].dst = dst + bounds[i];
+          jobs[n_jobs].n1 = bounds[i + 1] - bounds[i];
+          jobs[n_jobs].n2 = bounds[i + 2] - bounds[i + 1];
+          n_jobs++;
+        }
+      /* odd run is just copied */
+      if (n_runs & 1)
+        memcpy (dst + bounds[n_runs - 1], src + bounds[n_runs - 1],
+                (n - bounds[n_runs - 1]) * sizeof (guint));
+      run_jobs (jobs, n_jobs);
+
+      for (i = 0, k = 0; i < n_runs; i += 2)
+        bounds[k++] = bounds[i];
+      bounds[k] = n;
+      n_runs = k;
+
+      tmp = src;
+      src = dst;
+      dst = tmp;
+    }
+
+  g_free (dst);
+  g_free (bounds);
+  g_free (jobs);
+
+  return src;
+}
+
+/* find position for the slot in sorted list */
+static guint
+sorted_pos (YadListModel *model, guint slot)
+{
+  guint lo = 0, hi = model->n_rows;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+      guint s = row_slot (model, mid);
+
+      if (compare_slots (&s, &slot, model) <= 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static void
+sort_rows (YadListModel *model)
+{
+  GtkTreePath *path;
+  guint *slots;
+  gint *new_order;
+  guint i;
+
+  if (!is_sorted (model))
+    return;
+
+  slots = g_new (guint, model->n_rows);
+  for (i = 0; i < model->n_rows; i++)
+    slots[i] = row_slot (model, i);
+
+  /* keys are needed for inserting of new rows too */
+  for (i = 0; i < model->n_sort_keys; i++)
+    ensure_keys (model, model->sort_keys[i].column, slots);
+
+  if (model->n_rows < 2)
+    {
+      g_free (slots);
+      return;
+    }
+
+  slots = sort_slots (model, slots, model->n_rows);
+
+  new_order = g_new (gint, model->n_rows);
+  for (i = 0; i < model->n_rows; i++)
+    {
+      new_order[i] = slot_pos (model, slots[i]);
+      model->order[i] = slots[i];
+      model->seq[slots[i]] = model->first_seq + i;
+    }
+  /* order array was rewritten from the beginning */
+  model->head = 0;
+
+  path = gtk_tree_path_new ();
+  gtk_tree_model_rows_reordered (GTK_TREE_MODEL (model), path, NULL, new_order);
+  gtk_tree_path_free (path);
+
+  g_free (new_order);
+  g_free (slots);
+}
+
+/* move changed row to its new place in sorted list */
+static void
+resort_row (YadListModel *model, guint slot)
+{
+  GtkTreePath *path;
+  gint *new_order;
+  guint i, old_pos, new_pos;
+
+  old_pos = slot_pos (model, slot);
+  remove_pos (model, old_pos);
+  new_pos = sorted_pos (model, slot);
+  insert_slot (model, new_pos, slot);
+
+  if (old_pos == new_pos)
+    return;
+
+  new_order = g_new (gint, model->n_rows);
+  for (i = 0; i < model->n_rows; i++)
+    new_order[i] = i;
+  if (new_pos < old_pos)
+    {
+      for (i = new_pos + 1; i <= old_pos; i++)
+        new_order[i] = i - 1;
+    }
+  else
+    {
+      for (i = old_pos; i < new_pos; i++)
+        new_order[i] = i + 1;
+    }
+  new_order[new_pos] = old_pos;
+
+  path = gtk_tree_path_new ();
+  gtk_tree_model_rows_reordered (GTK_TREE_MODEL (model), path, NULL, new_order);
+  gtk_tree_path_free (path);
+
+  g_free (new_order);
+}
+
+/* GtkTreeModel interface */
+
+static GtkTreeModelFlags
+yad_list_model_get_flags (GtkTreeModel *tm)
+{
+  return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+yad_list_model_get_n_columns (GtkTreeModel *tm)
+{
+  return YAD_LIST_MODEL (tm)->n_columns;
+}
+
+static GType
+yad_list_model_get_column_type (GtkTreeModel *tm, gint column)
+{
+  YadListModel *model = YAD_LIST_MODEL (tm);
+
+  g_return_val_if_fail (column >= 0 && column < model->n_columns, G_TYPE_INVALID);
+
+  return model->types[column];
+}
+
+static gboolean
+yad_list_model_get_iter (GtkTreeModel *tm, GtkTreeIter *iter, GtkTreePath *path)
+{
+  YadListModel *model = YAD_LIST_MODEL (tm);
+  gint pos;
+
+  if (gtk_tree_path_get_depth (path) != 1)
+    return FALSE;
+
+  pos = gtk_tree_path_get_indices (path)[0];
+  if (pos < 0 || pos >= model->n_rows)
+    return FALSE;
+
+  set_iter (model, iter, row_slot (model, pos));
+  return TRUE;
+}
+
+static GtkTreePath *
+yad_list_model_get_path (GtkTreeModel *tm, GtkTreeIter *iter)
+{
+  YadListModel *model = YAD_LIST_MODEL (tm);
+
+  g_return_val_if_fail (iter_is_valid (model, iter), NULL);
+
+  return gtk_tree_path_new_from_indices (slot_pos (model, GPOINTER_TO_UINT (iter->user_data)), -1);
+}
+
+static void
+yad_list_model_get_value (GtkTreeModel *tm, GtkTreeIter *iter, gint column, GValue *value)
+{
+  YadListModel *model = YAD_LIST_MODEL (tm);
+  YadListCell *cell;
+
+  g_return_if_fail (column >= 0 && column < model->n_columns);
+  g_return_if_fail (iter_is_valid (model, iter));
+
+  cell = &model->cells[column][GPOINTER_TO_UINT (iter->user_data)];
+
+  g_value_init (value, model->types[column]);
+  switch (G_TYPE_FUNDAMENTAL (model->types[column]))
+    {
+    case G_TYPE_STRING:
+      /* chunk may be compacted on the next change, so value gets its own copy */
+      g_value_set_string (value, cell->s);
+      break;
+    case G_TYPE_INT64:
+      g_value_set_int64 (value, cell->i);
+      break;
+    case G_TYPE_DOUBLE:
+      g_value_set_double (value, cell->d);
+      break;
+    case G_TYPE_BOOLEAN:
+      g_value_set_boolean (value, cell->b);
+      break;
+    case G_TYPE_OBJECT:
+      g_value_set_object (value, cell->o);
+      break;
+    default:
+      break;
+    }
+}
+
+static gboolean
+yad_list_model_iter_next (GtkTreeModel *tm, GtkTreeIter *iter)
+{
+  YadListModel *model = YAD_LIST_MODEL (tm);
+  guint pos;
+
+  g_return_val_if_fail (iter_is_valid (model, iter), FALSE);
+
+  pos = slot_pos (model, GPOINTER_TO_UINT (iter->user_data)) + 1;
+  if (pos >= model->n_rows)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  set_iter (model, iter, row_slot (model, pos));
+  return TRUE;
+}
+
+static gboolean
+yad_list_model_iter_previous (GtkTreeModel *tm, GtkTreeIter *iter)
+{
+  YadListModel *model = YAD_LIST_MODEL (tm);
+  guint pos;
+
+  g_return_val_if_fail (iter_is_valid (model, iter), FALSE);
+
+  pos = slot_pos (model, GPOINTER_TO_UINT (iter->user_data));
+  if (pos == 0)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  set_iter (model, iter, row_slot (model, pos - 1));
+  return TRUE;
+}
+
+static gboolean
+yad_list_model_iter_nth_child (GtkTreeModel *tm, GtkTreeIter *iter, GtkTreeIter *parent, gint n)
+{
+  YadListModel *model = YAD_LIST_MODEL (tm);
+
+  iter->stamp = 0;
+
+  if (parent || n < 0 || n >= model->n_rows)
+    return FALSE;
+
+  set_iter (model, iter, row_slot (model, n));
+  return TRUE;
+}
+
+static gboolean
+yad_list_model_iter_children (GtkTreeModel *tm, GtkTreeIter *iter, GtkTreeIter *parent)
+{
+  return yad_list_model_iter_nth_child (tm, iter, parent, 0);
+}
+
+static gboolean
+yad_list_model_iter_has_child (GtkTreeModel *tm, GtkTreeIter *iter)
+{
+  return FALSE;
+}
+
+static gint
+yad_list_model_iter_n_children (GtkTreeModel *tm, GtkTreeIter *iter)
+{
+  if (iter)
+    return 0;
+  return YAD_LIST_MODEL (tm)->n_rows;
+}
+
+static gboolean
+yad_list_model_iter_parent (GtkTreeModel *tm, GtkTreeIter *iter, GtkTreeIter *child)
+{
+  iter->stamp = 0;
+  return FALSE;
+}
+
+static void
+yad_list_model_tree_model_init (GtkTreeModelIface *iface)
+{
+  iface->get_flags = yad_list_model_get_flags;
+  iface->get_n_columns = yad_list_model_get_n_columns;
+  iface->get_column_type = yad_list_model_get_column_type;
+  iface->get_iter = yad_list_model_get_iter;
+  iface->get_path = yad_list_model_get_path;
+  iface->get_value = yad_list_model_get_value;
+  iface->iter_next = yad_list_model_iter_next;
+  iface->iter_previous = yad_list_model_iter_previous;
+  iface->iter_children = yad_list_model_iter_children;
+  iface->iter_has_child = yad_list_model_iter_has_child;
+  iface->iter_n_children = yad_list_model_iter_n_children;
+  iface->iter_nth_child = yad_list_model_iter_nth_child;
+  iface->iter_parent = yad_list_model_iter_parent;
+}
+
+/* GtkTreeSortable interface */
+
+static gboolean
+yad_list_model_get_sort_column_id (GtkTreeSortable *sortable, gint *sort_column_id, GtkSortType *order)
+{
+  YadListModel *model = YAD_LIST_MODEL (sortable);
+
+  if (sort_column_id)
+    *sort_column_id = model->sort_column_id;
+  if (order)
+    *order = model->sort_order;
+
+  return (model->sort_column_id != GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID &&
+          model->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID);
+}
+
+static void
+yad_list_model_set_sort_column_id (GtkTreeSortable *sortable, gint sort_column_id, GtkSortType order)
+{
+  YadListModel *model = YAD_LIST_MODEL (sortable);
+
+  if (model->sort_column_id == sort_column_id && model->sort_order == order)
+    return;
+
+  if (sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    g_return_if_fail (model->default_sort.func != NULL);
+  else if (sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
+    g_return_if_fail (sort_column_id >= 0 && sort_column_id < model->n_columns);
+
+  model->sort_column_id = sort_column_id;
+  model->sort_order = order;
+
+  /* new column becomes the first key, others keep their order */
+  if (sort_column_id >= 0)
+    {
+      gint i, n = 1;
+      YadListSortKey *keys = g_new (YadListSortKey, model->n_columns);
+
+      keys[0].column = sort_column_id;
+      keys[0].order = order;
+      for (i = 0; i < model->n_sort_keys; i++)
+        {
+          if (model->sort_keys[i].column != sort_column_id)
+            keys[n++] = model->sort_keys[i];
+        }
+      g_free (model->sort_keys);
+      model->sort_keys = keys;
+      model->n_sort_keys = n;
+    }
+  else
+    model->n_sort_keys = 0;
+
+  gtk_tree_sortable_sort_column_changed (sortable);
+  sort_rows (model);
+}
+
+static void
+set_sort_func (YadListSortFunc *sf, GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy)
+{
+  if (sf->destroy)
+    sf->destroy (sf->data);
+
+  sf->func = func;
+  sf->data = data;
+  sf->destroy = destroy;
+}
+
+static void
+yad_list_model_set_sort_func (GtkTreeSortable *sortable, gint sort_column_id,
+                              GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy)
+{
+  YadListModel *model = YAD_LIST_MODEL (sortable);
+
+  g_return_if_fail (sort_column_id >= 0 && sort_column_id < model->n_columns);
+
+  set_sort_func (&model->sort_funcs[sort_column_id], func, data, destroy);
+
+  if (model->sort_column_id == sort_column_id)
+    sort_rows (model);
+}
+
+static void
+yad_list_model_set_default_sort_func (GtkTreeSortable *sortable, GtkTreeIterCompareFunc func,
+                                      gpointer data, GDestroyNotify destroy)
+{
+  YadListModel *model = YAD_LIST_MODEL (sortable);
+
+  set_sort_func (&model->default_sort, func, data, destroy);
+
+  if (model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    sort_rows (model);
+}
+
+static gboolean
+yad_list_model_has_default_sort_func (GtkTreeSortable *sortable)
+{
+  return (YAD_LIST_MODEL (sortable)->default_sort.func != NULL);
+}
+
+static void
+yad_list_model_sortable_init (GtkTreeSortableIface *iface)
+{
+  iface->get_sort_column_id = yad_list_model_get_sort_column_id;
+  iface->set_sort_column_id = yad_list_model_set_sort_column_id;
+  iface->set_sort_func = yad_list_model_set_sort_func;
+  iface->set_default_sort_func = yad_list_model_set_default_sort_func;
+  iface->has_default_sort_func = yad_list_model_has_default_sort_func;
+}
+
+/* object */
+
+static void
+yad_list_model_finalize (GObject *obj)
+{
+  YadListModel *model = YAD_LIST_MODEL (obj);
+  gint i;
+
+  for (i = 0; i < model->n_columns; i++)
+    {
+      if (G_TYPE_IS_OBJECT (model->types[i]))
+        {
+          guint j;
+
+          for (j = 0; j < model->n_rows; j++)
+            {
+              gpointer o = model->cells[i][row_slot (model, j)].o;
+              if (o)
+                g_object_unref (o);
+            }
+        }
+      if (model->keys[i])
+        {
+          guint j;
+
+          for (j = 0; j < model->n_rows; j++)
+            g_free (model->keys[i][row_slot (model, j)]);
+          g_free (model->keys[i]);
+        }
+      g_free (model->cells[i]);
+      set_sort_func (&model->sort_funcs[i], NULL, NULL, NULL);
+    }
+  set_sort_func (&model->default_sort, NULL, NULL, NULL);
+
+  g_free (model->cells);
+  g_free (model->keys);
+  g_free (model->sort_keys);
+  g_free (model->sort_funcs);
+  g_free (model->types);
+  g_free (model->seq);
+  g_free (model->order);
+  g_array_free (model->free_slots, TRUE);
+  g_hash_table_destroy (model->interned);
+  g_string_chunk_free (model->strings);
+
+  G_OBJECT_CLASS (yad_list_model_parent_class)->finalize (obj);
+}
+
+static void
+yad_list_model_class_init (YadListModelClass *klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = yad_list_model_finalize;
+}
+
+static void
+yad_list_model_init (YadListModel *model)
+{
+  model->stamp = g_random_int ();
+  model->strings = g_string_chunk_new (STRING_CHUNK_SIZE);
+  model->interned = g_hash_table_new (g_str_hash, g_str_equal);
+  model->free_slots = g_array_new (FALSE, FALSE, sizeof (guint));
+  model->sort_column_id = GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
+  model->sort_order = GTK_SORT_ASCENDING;
+}
+
+YadListModel *
+yad_list_model_new (gint n_columns, GType *types)
+{
+  YadListModel *model;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  model = g_object_new (YAD_TYPE_LIST_MODEL, NULL);
+
+  model->n_columns = n_columns;
+  model->types = g_new (GType, n_columns);
+  memcpy (model->types, types, n_columns * sizeof (GType));
+  model->cells = g_new0 (YadListCell *, n_columns);
+  model->keys = g_new0 (gchar **, n_columns);
+  model->sort_funcs = g_new0 (YadListSortFunc, n_columns);
+
+  return model;
+}
+
+/* public api */
+
+void
+yad_list_model_insert_with_valuesv (YadListModel *model, GtkTreeIter *iter, gint position,
+                                    gint *columns, GValue *values, gint n_values)
+{
+  GtkTreePath *path;
+  GtkTreeIter it;
+  guint slot, pos;
+  gint i;
+
+  g_return_if_fail (YAD_IS_LIST_MODEL (model));
+
+  slot = alloc_slot (model);
+  for (i = 0; i < n_values; i++)
+    set_cell (model, slot, columns[i], &values[i]);
+
+  if (is_sorted (model))
+    pos = sorted_pos (model, slot);
+  else if (position < 0 || position > model->n_rows)
+    pos = model->n_rows;
+  else
+    pos = position;
+
+  insert_slot (model, pos, slot);
+
+  if (iter == NULL)
+    iter = &it;
+  set_iter (model, iter, slot);
+
+  path = gtk_tree_path_new_from_indices (pos, -1);
+  gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, iter);
+  gtk_tree_path_free (path);
+
+  /* values may point to the model strings, so compact only after they are stored */
+  maybe_compact (model);
+}
+
+static void
+row_changed (YadListModel *model, GtkTreeIter *iter, gboolean resort)
+{
+  GtkTreePath *path;
+  guint slot = GPOINTER_TO_UINT (iter->user_data);
+
+  path = gtk_tree_path_new_from_indices (slot_pos (model, slot), -1);
+  gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, iter);
+  gtk_tree_path_free (path);
+
+  if (resort && is_sorted (model))
+    resort_row (model, slot);
+}
+
+void
+yad_list_model_set_value (YadListModel *model, GtkTreeIter *iter, gint column, GValue *value)
+{
+  g_return_if_fail (YAD_IS_LIST_MODEL (model));
+  g_return_if_fail (iter_is_valid (model, iter));
+  g_return_if_fail (column >= 0 && column < model->n_columns);
+
+  if (set_cell (model, GPOINTER_TO_UINT (iter->user_data), column, value))
+    row_changed (model, iter, sorted_by (model, column));
+}
+
+/* set several cells at once. row-changed is emitted only if something was really changed */
+void
+yad_list_model_set_valuesv (YadListModel *model, GtkTreeIter *iter, gint *columns, GValue *values, gint n_values)
+{
+  gboolean changed = FALSE, resort = FALSE;
+  gint i;
+
+  g_return_if_fail (YAD_IS_LIST_MODEL (model));
+  g_return_if_fail (iter_is_valid (model, iter));
+
+  for (i = 0; i < n_values; i++)
+    {
+      g_return_if_fail (columns[i] >= 0 && columns[i] < model->n_columns);
+
+      if (set_cell (model, GPOINTER_TO_UINT (iter->user_data), columns[i], &values[i]))
+        {
+          changed = TRUE;
+          if (sorted_by (model, columns[i]))
+            resort = TRUE;
+        }
+    }
+
+  if (changed)
+    row_changed (model, iter, resort);
+
+  maybe_compact (model);
+}
+
+void
+yad_list_model_set_valist (YadListModel *model, GtkTreeIter *iter, va_list args)
+{
+  gboolean changed = FALSE, resort = FALSE;
+  gint column;
+
+  g_return_if_fail (YAD_IS_LIST_MODEL (model));
+  g_return_if_fail (iter_is_valid (model, iter));
+
+  column = va_arg (args, gint);
+  while (column != -1)
+    {
+      GValue value = G_VALUE_INIT;
+      gchar *err = NULL;
+
+      if (column < 0 || column >= model->n_columns)
+        {
+          g_warning ("Invalid column number %d added to iter", column);
+          break;
+        }
+
+      G_VALUE_COLLECT_INIT (&value, model->types[column], args, 0, &err);
+      if (err)
+        {
+          g_warning ("%s: %s", G_STRFUNC, err);
+          g_free (err);
+          break;
+        }
+
+      if (set_cell (model, GPOINTER_TO_UINT (iter->user_data), column, &value))
+        {
+          changed = TRUE;
+          if (sorted_by (model, column))
+            resort = TRUE;
+        }
+      g_value_unset (&value);
+
+      column = va_arg (args, gint);
+    }
+
+  if (changed)
+    row_changed (model, iter, resort);
+}
+
+void
+yad_list_model_set (YadListModel *model, GtkTreeIter *iter, ...)
+{
+  va_list args;
+
+  va_start (args, iter);
+  yad_list_model_set_valist (model, iter, args);
+  va_end (args);
+}
+
+gboolean
+yad_list_model_remove (YadListModel *model, GtkTreeIter *iter)
+{
+  GtkTreePath *path;
+  guint slot, pos;
+
+  g_return_val_if_fail (YAD_IS_LIST_MODEL (model), FALSE);
+  g_return_val_if_fail (iter_is_valid (model, iter), FALSE);
+
+  slot = GPOINTER_TO_UINT (iter->user_data);
+  pos = slot_pos (model, slot);
+
+  remove_pos (model, pos);
+  free_slot (model, slot);
+
+  path = gtk_tree_path_new_from_indices (pos, -1);
+  gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+  gtk_tree_path_free (path);
+
+  /* like GtkListStore, set iter to the next row */
+  if (pos < model->n_rows)
+    {
+      set_iter (model, iter, row_slot (model, pos));
+      return TRUE;
+    }
+
+  iter->stamp = 0;
+  return FALSE;
+}
+
+void
+yad_list_model_clear (YadListModel *model)
+{
+  g_return_if_fail (YAD_IS_LIST_MODEL (model));
+
+  /* remove rows from the end, so no shifting is needed */
+  while (model->n_rows > 0)
+    {
+      GtkTreePath *path;
+      guint pos = model->n_rows - 1;
+
+      free_slot (model, row_slot (model, pos));
+      model->n_rows--;
+
+      path = gtk_tree_path_new_from_indices (pos, -1);
+      gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+      gtk_tree_path_free (path);
+    }
+
+  model->n_slots = 0;
+  g_array_set_size (model->free_slots, 0);
+  model->head = 0;
+  model->first_seq = 0;
+
+  g_string_chunk_clear (model->strings);
+  g_hash_table_remove_all (model->interned);
+  model->chunk_bytes = model->live_bytes = 0;
+
+  /* invalidate all iterators */
+  do
+    model->stamp++;
+  while (model->stamp == 0);
+}
+
+/* set multi-column sort. first column becomes the sort column of the model */
+void
+yad_list_model_set_sort_keys (YadListModel *model, gint n_keys, gint *columns, GtkSortType *orders)
+{
+  gint i;
+
+  g_return_if_fail (YAD_IS_LIST_MODEL (model));
+  g_return_if_fail (n_keys > 0 && n_keys <= model->n_columns);
+
+  for (i = 0; i < n_keys; i++)
+    g_return_if_fail (columns[i] >= 0 && columns[i] < model->n_columns);
+
+  g_free (model->sort_keys);
+  model->sort_keys = g_new (YadListSortKey, model->n_columns);
+  for (i = 0; i < n_keys; i++)
+    {
+      model->sort_keys[i].column = columns[i];
+      model->sort_keys[i].order = orders[i];
+    }
+  model->n_sort_keys = n_keys;
+
+  model->sort_column_id = columns[0];
+  model->sort_order = orders[0];
+
+  gtk_tree_sortable_sort_column_changed (GTK_TREE_SORTABLE (model));
+  sort_rows (model);
+}
+
+/* returned string belongs to the model and is valid only until the next change
+   of the model. copy it if it must be kept longer */
+const gchar *
+yad_list_model_get_string (YadListModel *model, GtkTreeIter *iter, gint column)
+{
+  g_return_val_if_fail (iter_is_valid (model, iter), NULL);
+  return model->cells[column][GPOINTER_TO_UINT (iter->user_data)].s;
+}
+
+gint64
+yad_list_model_get_int64 (YadListModel *model, GtkTreeIter *iter, gint column)
+{
+  g_return_val_if_fail (iter_is_valid (model, iter), 0);
+  return model->cells[column][GPOINTER_TO_UINT (iter->user_data)].i;
+}
+
+gdouble
+yad_list_model_get_double (YadListModel *model, GtkTreeIter *iter, gint column)
+{
+  g_return_val_if_fail (iter_is_valid (model, iter), 0.0);
+  return model->cells[column][GPOINTER_TO_UINT (iter->user_data)].d;
+}
+
+gboolean
+yad_list_model_get_boolean (YadListModel *model, GtkTreeIter *iter, gint column)
+{
+  g_return_val_if_fail (iter_is_valid (model, iter), FALSE);
+  return model->cells[column][GPOINTER_TO_UINT (iter->user_data)].b;
+}
+
+guint
+yad_list_model_get_row_id (YadListModel *model, GtkTreeIter *iter)
+{
+  g_return_val_if_fail (iter_is_valid (model, iter), 0);
+  return GPOINTER_TO_UINT (iter->user_data);
+}
@@ -0,0 +1,58 @@
+/*
+ * This file is part of YAD.
+ *
+ * YAD is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YAD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YAD. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2008-2025, Victor Ananjevsky <victor@sanana.kiev.ua>
+ */
+
+#ifndef __LISTMODEL_H__
+#define __LISTMODEL_H__
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/* flat list model with column-wise storage. supported column types are
+   G_TYPE_STRING, G_TYPE_INT64, G_TYPE_DOUBLE, G_TYPE_BOOLEAN and objects */
+#define YAD_TYPE_LIST_MODEL (yad_list_model_get_type ())
+G_DECLARE_FINAL_TYPE (YadListModel, yad_list_model, YAD, LIST_MODEL, GObject)
+
+YadListModel *yad_list_model_new (gint n_columns, GType *types);
+
+void yad_list_model_insert_with_valuesv (YadListModel *model, GtkTreeIter *iter, gint position,
+                                         gint *columns, GValue *values, gint n_values);
+void yad_list_model_set_value (YadListModel *model, GtkTreeIter *iter, gint column, GValue *value);
+void yad_list_model_set_valuesv (YadListModel *model, GtkTreeIter *iter, gint *columns,
+                                 GValue *values, gint n_values);
+void yad_list_model_set_valist (YadListModel *model, GtkTreeIter *iter, va_list args);
+void yad_list_model_set (YadListModel *model, GtkTreeIter *iter, ...);
+gboolean yad_list_model_remove (YadListModel *model, GtkTreeIter *iter);
+void yad_list_model_clear (YadListModel *model);
+
+void yad_list_model_set_sort_keys (YadListModel *model, gint n_keys, gint *columns, GtkSortType *orders);
+
+/* direct access to the cells without GValue conversion.
+   strings are valid only until the next change of the model */
+const gchar *yad_list_model_get_string (YadListModel *model, GtkTreeIter *iter, gint column);
+gint64 yad_list_model_get_int64 (YadListModel *model, GtkTreeIter *iter, gint column);
+gdouble yad_list_model_get_double (YadListModel *model, GtkTreeIter *iter, gint column);
+gboolean yad_list_model_get_boolean (YadListModel *model, GtkTreeIter *iter, gint column);
+
+/* identifier of the row which is unique while the row exists */
+guint yad_list_model_get_row_id (YadListModel *model, GtkTreeIter *iter);
+
+G_END_DECLS
+
+#endif /* __LISTMODEL_H__ */
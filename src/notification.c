@@ -123,13 +123,27 @@ set_icon (void)
   if (g_file_test (icon, G_FILE_TEST_EXISTS))
     {
       gint isize = (options.common_data.icon_size > 0) ? options.common_data.icon_size : 16;
+      GStatBuf st;
+      gchar *key;
 
-      pixbuf = gdk_pixbuf_new_from_file_at_scale (icon, isize, isize, TRUE, &err);
-      if (err)
+      /* icons are often switched back and forth, so keep loaded ones.
+         file may be rewritten with the new image, so its mtime is a part of the key */
+      if (g_stat (icon, &st) != 0)
+        st.st_mtime = 0;
+      key = g_strdup_printf ("notify:%d:%ld:%s", isize, (glong) st.st_mtime, icon);
+
+      pixbuf = pixbuf_cache_lookup (key);
+      if (pixbuf == NULL)
         {
-          g_printerr (_("Could not load notification icon '%s': %s\n"), icon, err->message);
-          g_clear_error (&err);
+          pixbuf = gdk_pixbuf_new_from_file_at_scale (icon, isize, isize, TRUE, &err);
+          if (err)
+            {
+              g_printerr (_("Could not load notification icon '%s': %s\n"), icon, err->message);
+              g_clear_error (&err);
+            }
+          pixbuf_cache_insert (key, pixbuf);
         }
+      g_free (key);
       if (pixbuf)
         {
           G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
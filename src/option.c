@@ -51,6 +51,8 @@ static gboolean parse_signal (const gchar *, const gchar *, gpointer, GError **)
 static gboolean add_image_path (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_complete_type (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_bool_fmt_type (const gchar *, const gchar *, gpointer, GError **);
+static gboolean set_output_fmt (const gchar *, const gchar *, gpointer, GError **);
+static gboolean set_input_fmt (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_grid_lines (const gchar *, const gchar *, gpointer, GError **);
 static gboolean set_scroll_policy (const gchar *, const gchar *, gpointer, GError **);
 #if GLIB_CHECK_VERSION(2,30,0)
@@ -146,6 +148,8 @@ static GOptionEntry general_options[] = {
     N_("Dialog text can be selected"), NULL },
   { "keep-icon-size", 0, 0, G_OPTION_ARG_NONE, &options.data.keep_icon_size,
     N_("Don't scale icons"), NULL },
+  { "icon-cache", 0, 0, G_OPTION_ARG_INT, &options.data.icon_cache,
+    N_("Set maximum size of icons cache in kilobytes"), N_("SIZE") },
   { "use-interp", 0, G_OPTION_FLAG_OPTIONAL_ARG, G_OPTION_ARG_CALLBACK, set_interp,
     N_("Run commands under specified interpreter (default: bash -c '%s')"), N_("CMD") },
   { "uri-handler", 0, 0, G_OPTION_ARG_STRING, &options.data.uri_handler,
@@ -241,6 +245,12 @@ static GOptionEntry common_options[] = {
     N_("Set extended completion for entries (any, all, or regex)"), N_("TYPE") },
   { "bool-fmt", 0, 0, G_OPTION_ARG_CALLBACK, set_bool_fmt_type,
     N_("Set type of output for boolean values (T, t, Y, y, O, o, 1)"), N_("TYPE") },
+  { "output-format", 0, 0, G_OPTION_ARG_CALLBACK, set_output_fmt,
+    N_("Set format of dialogs output (shell, nul, csv or json)"), N_("FORMAT") },
+  { "input-format", 0, 0, G_OPTION_ARG_CALLBACK, set_input_fmt,
+    N_("Set format of records on stdin (lines, nul or netstring)"), N_("FORMAT") },
+  { "encoding", 0, 0, G_OPTION_ARG_STRING, &options.common_data.encoding,
+    N_("Set charset of data on stdin"), N_("CHARSET") },
   { "scroll", 0, 0, G_OPTION_ARG_NONE, &options.common_data.scroll,
     N_("Make main widget scrollable"), NULL },
   { "disable-search", 0, G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &options.common_data.enable_search,
@@ -489,6 +499,10 @@ static GOptionEntry list_options[] = {
     N_("Set ellipsize mode for text columns (none, start, middle or end)"), N_("TYPE") },
   { "ellipsize-cols", 0, 0, G_OPTION_ARG_STRING, &options.list_data.ellipsize_cols,
     N_("Set the list of ellipsized columns"), N_("LIST") },
+  { "fixed-layout", 0, 0, G_OPTION_ARG_NONE, &options.list_data.fixed_layout,
+    N_("Use fixed size columns and rows for fast drawing of big lists"), NULL },
+  { "column-widths", 0, 0, G_OPTION_ARG_STRING, &options.list_data.col_widths,
+    N_("Set the widths of columns for fixed layout"), N_("LIST") },
   { "print-column", 0, 0, G_OPTION_ARG_INT, &options.list_data.print_column,
     N_("Print a specific column. By default or if 0 is specified will be printed all columns"), N_("NUMBER") },
   { "hide-column", 0, 0, G_OPTION_ARG_INT, &options.list_data.hide_column,
@@ -505,16 +519,28 @@ static GOptionEntry list_options[] = {
     N_("Set the row separator value"), N_("TEXT") },
   { "limit", 0, 0, G_OPTION_ARG_INT, &options.list_data.limit,
     N_("Set the limit of rows in list"), N_("NUMBER") },
+  { "key-column", 0, 0, G_OPTION_ARG_INT, &options.list_data.key_column,
+    N_("Set the column with unique row keys for updating rows"), N_("NUMBER") },
   { "dclick-action", 0, 0, G_OPTION_ARG_STRING, &options.list_data.dclick_action,
     N_("Set double-click action"), N_("CMD") },
   { "select-action", 0, 0, G_OPTION_ARG_STRING, &options.list_data.select_action,
     N_("Set select action"), N_("CMD") },
   { "row-action", 0, 0, G_OPTION_ARG_STRING, &options.list_data.row_action,
     N_("Set row action"), N_("CMD") },
+  { "action-delay", 0, 0, G_OPTION_ARG_INT, &options.list_data.action_delay,
+    N_("Set delay for select action in milliseconds"), N_("MS") },
   { "tree-expanded", 0, 0, G_OPTION_ARG_NONE, &options.list_data.tree_expanded,
     N_("Expand all tree nodes"), NULL },
+  { "tree-loader", 0, 0, G_OPTION_ARG_STRING, &options.list_data.tree_loader,
+    N_("Load children of tree nodes on expanding with command"), N_("CMD") },
+  { "tree-unload", 0, 0, G_OPTION_ARG_NONE, &options.list_data.tree_unload,
+    N_("Unload children of collapsed tree nodes"), NULL },
   { "regex-search", 0, 0, G_OPTION_ARG_NONE, &options.list_data.regex_search,
     N_("Use regex in search"), NULL },
+  { "live-filter", 0, 0, G_OPTION_ARG_NONE, &options.list_data.live_filter,
+    N_("Show only rows matching the search"), NULL },
+  { "sort-by", 0, 0, G_OPTION_ARG_STRING, &options.list_data.sort_by,
+    N_("Set initial sorting by columns (negative number for descending order)"), N_("LIST") },
   { "no-selection", 0, 0, G_OPTION_ARG_NONE, &options.list_data.no_selection,
     N_("Disable selection"), NULL },
   { "add-on-top", 0, 0, G_OPTION_ARG_NONE, &options.list_data.add_on_top,
@@ -656,6 +682,8 @@ static GOptionEntry progress_options[] = {
     N_("Place log window above progress bar"), NULL },
   { "log-height", 0, 0, G_OPTION_ARG_INT, &options.progress_data.log_height,
     N_("Height of log window"), NULL },
+  { "list-view", 0, 0, G_OPTION_ARG_NONE, &options.progress_data.list_view,
+    N_("Show bars as rows of list"), NULL },
   { NULL }
 };
 
@@ -714,6 +742,12 @@ static GOptionEntry text_options[] = {
     N_("Save file instead of print on exit"), NULL },
   { "confirm-save", 0, G_OPTION_FLAG_OPTIONAL_ARG, G_OPTION_ARG_CALLBACK, add_confirm_save,
     N_("Confirm save the file if text was changed"), N_("[TEXT]") },
+  { "max-lines", 0, 0, G_OPTION_ARG_INT, &options.text_data.max_lines,
+    N_("Set the maximum number of lines kept from stdin"), N_("NUMBER") },
+  { "pager", 0, 0, G_OPTION_ARG_NONE, &options.text_data.pager,
+    N_("Show big files by parts"), NULL },
+  { "ansi", 0, 0, G_OPTION_ARG_NONE, &options.text_data.ansi,
+    N_("Show colors from ANSI escape sequences"), NULL },
   { NULL }
 };
 
@@ -1354,6 +1388,38 @@ set_bool_fmt_type (const gchar * option_name, const gchar * value, gpointer data
   return TRUE;
 }
 
+static gboolean
+set_output_fmt (const gchar * option_name, const gchar * value, gpointer data, GError ** err)
+{
+  if (strcasecmp (value, "shell") == 0)
+    options.common_data.output_fmt = YAD_OUTPUT_SHELL;
+  else if (strcasecmp (value, "nul") == 0)
+    options.common_data.output_fmt = YAD_OUTPUT_NUL;
+  else if (strcasecmp (value, "csv") == 0)
+    options.common_data.output_fmt = YAD_OUTPUT_CSV;
+  else if (strcasecmp (value, "json") == 0)
+    options.common_data.output_fmt = YAD_OUTPUT_JSON;
+  else
+    g_printerr (_("Unknown output format: %s\n"), value);
+
+  return TRUE;
+}
+
+static gboolean
+set_input_fmt (const gchar * option_name, const gchar * value, gpointer data, GError ** err)
+{
+  if (strcasecmp (value, "lines") == 0)
+    options.common_data.input_fmt = YAD_INPUT_LINES;
+  else if (strcasecmp (value, "nul") == 0)
+    options.common_data.input_fmt = YAD_INPUT_NUL;
+  else if (strcasecmp (value, "netstring") == 0)
+    options.common_data.input_fmt = YAD_INPUT_NETSTRING;
+  else
+    g_printerr (_("Unknown input format: %s\n"), value);
+
+  return TRUE;
+}
+
 static gboolean
 set_grid_lines (const gchar * option_name, const gchar * value, gpointer data, GError ** err)
 {
@@ -1689,6 +1755,7 @@ yad_options_init (void)
   options.data.always_print = FALSE;
   options.data.selectable_labels = FALSE;
   options.data.keep_icon_size = FALSE;
+  options.data.icon_cache = 8192;
   options.data.def_resp = YAD_RESPONSE_OK;
   options.data.use_interp = FALSE;
   options.data.interp = "bash -c \"%s\"";
@@ -1737,6 +1804,9 @@ yad_options_init (void)
   options.common_data.filters = NULL;
   options.common_data.key = -1;
   options.common_data.bool_fmt = YAD_BOOL_FMT_UT;
+  options.common_data.output_fmt = YAD_OUTPUT_SHELL;
+  options.common_data.input_fmt = YAD_INPUT_LINES;
+  options.common_data.encoding = NULL;
   options.common_data.complete = YAD_COMPLETE_SIMPLE;
   options.common_data.icon_size = 0;
   options.common_data.scroll = FALSE;
@@ -1857,16 +1927,24 @@ yad_options_init (void)
   options.list_data.sep_column = 0;
   options.list_data.sep_value = NULL;
   options.list_data.limit = 0;
+  options.list_data.key_column = 0;
   options.list_data.editable_cols = NULL;
   options.list_data.wrap_width = 0;
   options.list_data.wrap_cols = NULL;
   options.list_data.ellipsize = PANGO_ELLIPSIZE_NONE;
   options.list_data.ellipsize_cols = NULL;
+  options.list_data.fixed_layout = FALSE;
+  options.list_data.col_widths = NULL;
   options.list_data.dclick_action = NULL;
   options.list_data.select_action = NULL;
   options.list_data.row_action = NULL;
+  options.list_data.action_delay = 0;
   options.list_data.tree_expanded = FALSE;
+  options.list_data.tree_loader = NULL;
+  options.list_data.tree_unload = FALSE;
   options.list_data.regex_search = FALSE;
+  options.list_data.live_filter = FALSE;
+  options.list_data.sort_by = NULL;
   options.list_data.clickable = TRUE;
   options.list_data.no_selection = FALSE;
   options.list_data.add_on_top = FALSE;
@@ -1923,6 +2001,7 @@ yad_options_init (void)
   options.progress_data.log_expanded = FALSE;
   options.progress_data.log_on_top = FALSE;
   options.progress_data.log_height = -1;
+  options.progress_data.list_view = FALSE;
 
   /* Initialize scale data */
   options.scale_data.value = 0;
@@ -1951,6 +2030,9 @@ yad_options_init (void)
   options.text_data.uri_color = settings->uri_color;
   options.text_data.formatted = FALSE;
   options.text_data.in_place = FALSE;
+  options.text_data.max_lines = 0;
+  options.text_data.pager = FALSE;
+  options.text_data.ansi = FALSE;
 
 #ifdef HAVE_SOURCEVIEW
   /* Initialize sourceview data */
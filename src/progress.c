@@ -26,223 +26,491 @@
 
 #include "yad.h"
 
-static GSList *progress_bars = NULL;
-static guint nbars = 0;
+/* size of bars list before scrolling */
+#define PROGRESS_LIST_HEIGHT 400
+
+enum {
+  BAR_COL_NAME,
+  BAR_COL_VALUE,
+  BAR_COL_TEXT,
+  BAR_COL_PULSE,
+  BAR_COL_INVERTED,
+  BAR_N_COLS
+};
+
+typedef struct {
+  gchar *name;
+  YadProgressType type;
+  /* progress bar widget in grid mode or row in list mode */
+  GtkWidget *bar;
+  GtkTreeIter iter;
+  gdouble fraction;
+  gint pulse;
+  guint timer;
+  /* pending changes. new fraction is negative if it wasn't changed */
+  gboolean dirty;
+  gdouble new_fraction;
+  gchar *new_text;
+  gboolean new_pulse;
+} YadBar;
+
+/* bars by number. removed bars leave empty slots, so numbers of others are kept */
+static GPtrArray *bars = NULL;
+static GHashTable *bar_names = NULL;
+/* bars with pending changes */
+static GPtrArray *dirty_bars = NULL;
+/* number of bars checked for auto close and number of finished ones */
+static guint n_watched = 0;
+static guint n_complete = 0;
+static gboolean check_close = FALSE;
+
+static GtkListStore *bar_store = NULL;
 
 static GtkWidget *progress_log;
 static GtkTextBuffer *log_buffer;
 
 static gboolean single_mode = FALSE;
 
+static GPtrArray *log_lines = NULL;
+static GtkTextMark *log_end = NULL;
+static GtkWidget *progress_table;
+static guint update_tick = 0;
+static guint update_timer = 0;
+
+#define UPDATE_TIMEOUT 16
+
+static void
+bar_pulse (YadBar *b)
+{
+  if (bar_store)
+    {
+      b->pulse++;
+      gtk_list_store_set (bar_store, &b->iter, BAR_COL_PULSE, b->pulse, -1);
+    }
+  else
+    gtk_progress_bar_pulse (GTK_PROGRESS_BAR (b->bar));
+}
+
 static gboolean
-pulsate_progress_bar (GtkProgressBar *bar)
+pulsate_progress_bar (YadBar *b)
 {
-  gtk_progress_bar_pulse (bar);
+  bar_pulse (b);
   return G_SOURCE_CONTINUE;
 }
 
+static void
+bar_set_fraction (YadBar *b, gdouble fraction)
+{
+  /* keep the number of finished bars instead of checking all of them */
+  if (b->type != YAD_PROGRESS_PULSE && (b->fraction == 1.0) != (fraction == 1.0))
+    {
+      if (fraction == 1.0)
+        n_complete++;
+      else
+        n_complete--;
+      check_close = TRUE;
+    }
+  b->fraction = fraction;
+
+  if (bar_store)
+    gtk_list_store_set (bar_store, &b->iter, BAR_COL_VALUE, (gint) (fraction * 100 + 0.5), -1);
+  else
+    gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (b->bar), fraction);
+}
+
+static void
+bar_set_text (YadBar *b, const gchar *text)
+{
+  if (bar_store)
+    gtk_list_store_set (bar_store, &b->iter, BAR_COL_TEXT, text, -1);
+  else
+    gtk_progress_bar_set_text (GTK_PROGRESS_BAR (b->bar), text);
+}
+
+static YadBar *
+bar_new (const gchar *name, YadProgressType type)
+{
+  YadBar *b = g_new0 (YadBar, 1);
+
+  b->name = g_strdup (name ? name : "");
+  b->type = type;
+  b->new_fraction = -1;
+
+  g_ptr_array_add (bars, b);
+  if (!g_hash_table_contains (bar_names, b->name))
+    g_hash_table_insert (bar_names, b->name, b);
+  if (type != YAD_PROGRESS_PULSE)
+    n_watched++;
+
+  return b;
+}
+
+/* add bar as a row of list */
+static void
+bar_add_row (YadBar *b)
+{
+  gtk_list_store_append (bar_store, &b->iter);
+  gtk_list_store_set (bar_store, &b->iter,
+                      BAR_COL_NAME, b->name,
+                      BAR_COL_VALUE, 0,
+                      BAR_COL_TEXT, options.common_data.hide_text ? "" : NULL,
+                      BAR_COL_PULSE, -1,
+                      BAR_COL_INVERTED, b->type == YAD_PROGRESS_RTL,
+                      -1);
+
+  if (b->type == YAD_PROGRESS_CPULSE)
+    b->timer = g_timeout_add_seconds (1, (GSourceFunc) pulsate_progress_bar, b);
+}
+
+static void
+bar_remove (YadBar *b)
+{
+  guint i;
+
+  for (i = 0; i < bars->len; i++)
+    {
+      if (g_ptr_array_index (bars, i) == b)
+        {
+          bars->pdata[i] = NULL;
+          break;
+        }
+    }
+  if (g_hash_table_lookup (bar_names, b->name) == b)
+    g_hash_table_remove (bar_names, b->name);
+  if (b->dirty)
+    g_ptr_array_remove (dirty_bars, b);
+
+  if (b->type != YAD_PROGRESS_PULSE)
+    {
+      n_watched--;
+      if (b->fraction == 1.0)
+        n_complete--;
+      check_close = TRUE;
+    }
+
+  if (b->timer)
+    g_source_remove (b->timer);
+  gtk_list_store_remove (bar_store, &b->iter);
+  g_free (b->new_text);
+  g_free (b->name);
+  g_free (b);
+}
+
+/* bars are found by number or by label. labels may start with digits too */
+static YadBar *
+find_bar (const gchar *key)
+{
+  const gchar *p;
+
+  for (p = key; g_ascii_isdigit (*p); p++);
+
+  if (p != key && *p == '\0')
+    {
+      guint num = atoi (key);
+      return (num > 0 && num <= bars->len) ? g_ptr_array_index (bars, num - 1) : NULL;
+    }
+  return g_hash_table_lookup (bar_names, key);
+}
+
+/* check if all of progress bars reaches 100% */
+static void
+check_autoclose ()
+{
+  YadBar *wb = NULL;
+
+  if (options.progress_data.watch_bar > 0 && options.progress_data.watch_bar <= bars->len)
+    wb = g_ptr_array_index (bars, options.progress_data.watch_bar - 1);
+
+  if (wb)
+    {
+      if (wb->fraction == 1.0)
+        yad_exit (options.data.def_resp);
+    }
+  else if (n_watched > 0 && n_complete == n_watched)
+    yad_exit (options.data.def_resp);
+}
+
+/* apply collected updates to widgets. called once per frame or by timer if widgets are not shown */
 static gboolean
-handle_stdin (GIOChannel *channel, GIOCondition condition, gpointer data)
+flush_updates (GtkWidget *w, GdkFrameClock *clock, gpointer data)
 {
-  float percentage = 0.0;
+  guint i;
+
+  /* w is NULL when called by timer */
+  if (w && update_timer)
+    g_source_remove (update_timer);
+  else if (!w && update_tick)
+    gtk_widget_remove_tick_callback (progress_table, update_tick);
+  update_tick = update_timer = 0;
 
-  if ((condition == G_IO_IN) || (condition == G_IO_IN + G_IO_HUP))
+  for (i = 0; i < dirty_bars->len; i++)
     {
-      GString *string;
-      gchar **value;
-      GError *err = NULL;
+      YadBar *b = g_ptr_array_index (dirty_bars, i);
 
-      string = g_string_new (NULL);
+      if (b->new_text)
+        {
+          bar_set_text (b, b->new_text);
+          g_free (b->new_text);
+          b->new_text = NULL;
+        }
+      if (b->new_pulse)
+        {
+          bar_pulse (b);
+          b->new_pulse = FALSE;
+        }
+      if (b->new_fraction >= 0)
+        {
+          bar_set_fraction (b, b->new_fraction);
+          b->new_fraction = -1;
+        }
+      b->dirty = FALSE;
+    }
+  g_ptr_array_set_size (dirty_bars, 0);
 
-      while (channel->is_readable != TRUE)
-        usleep (100);
+  if (log_lines && log_lines->len > 0)
+    {
+      GtkTextIter end;
 
-      do
+      for (i = 0; i < log_lines->len; i++)
         {
-          gint status, num;
-          GtkProgressBar *pb;
-          YadProgressBar *b;
+          gtk_text_buffer_get_end_iter (log_buffer, &end);
+          if (options.data.no_markup)
+            gtk_text_buffer_insert (log_buffer, &end, g_ptr_array_index (log_lines, i), -1);
+          else
+            gtk_text_buffer_insert_markup (log_buffer, &end, g_ptr_array_index (log_lines, i), -1);
+        }
+      g_ptr_array_set_size (log_lines, 0);
 
-          do
-            {
-              status = g_io_channel_read_line_string (channel, string, NULL, &err);
+      /* scroll to end */
+      gtk_text_view_scroll_to_mark (GTK_TEXT_VIEW (progress_log), log_end, 0, FALSE, 0, 0);
+    }
 
-              while (gtk_events_pending ())
-                gtk_main_iteration ();
-            }
-          while (status == G_IO_STATUS_AGAIN);
+  if (check_close && options.progress_data.autoclose && options.plug == -1)
+    check_autoclose ();
+  check_close = FALSE;
 
-          if (status != G_IO_STATUS_NORMAL)
-            {
-              if (err)
-                {
-                  g_printerr ("yad_multi_progress_handle_stdin(): %s\n", err->message);
-                  g_error_free (err);
-                  err = NULL;
-                }
-              /* stop handling */
-              g_io_channel_shutdown (channel, TRUE, NULL);
-              return FALSE;
-            }
+  return G_SOURCE_REMOVE;
+}
 
-          if (single_mode)
-            {
-              value = g_new0 (gchar *, 2);
-              value[1] = g_strdup (string->str);
-              num = 0;
-            }
-          else
-            {
-              value = g_strsplit (string->str, ":", 2);
-              num = atoi (value[0]) - 1;
-              if (num < 0 || num > nbars - 1)
-                continue;
-            }
+static gboolean
+flush_updates_timeout (gpointer data)
+{
+  return flush_updates (NULL, NULL, data);
+}
 
-          pb = GTK_PROGRESS_BAR (g_slist_nth_data (progress_bars, num));
-          b = (YadProgressBar *) g_slist_nth_data (options.progress_data.bars, num);
+static void
+schedule_update ()
+{
+  if (update_tick == 0 && update_timer == 0)
+    update_tick = gtk_widget_add_tick_callback (progress_table, flush_updates, NULL, NULL);
 
-          if (value[1] && value[1][0] == '#')
-            {
-              gchar *match;
-
-              /* We have a comment, so let's try to change the label */
-              match = g_strcompress (value[1] + 1);
-              strip_new_line (match);
-              if (options.progress_data.log)
-                {
-                  gchar *logline;
-                  GtkTextIter end;
-
-                  logline = g_strdup_printf ("%s\n", match);    /* add new line */
-                  gtk_text_buffer_get_end_iter (log_buffer, &end);
-                  if (options.data.no_markup)
-                    gtk_text_buffer_insert (log_buffer, &end, logline, -1);
-                  else
-                    gtk_text_buffer_insert_markup (log_buffer, &end, logline, -1);
-                  g_free (logline);
-
-                  /* scroll to end */
-                  while (gtk_events_pending ())
-                    gtk_main_iteration ();
-                  gtk_text_buffer_get_end_iter (log_buffer, &end);
-                  gtk_text_view_scroll_to_iter (GTK_TEXT_VIEW (progress_log), &end, 0, FALSE, 0, 0);
-                }
-              else
-                {
-                  if (!options.common_data.hide_text)
-                    gtk_progress_bar_set_text (pb, match);
-                }
-              g_free (match);
-            }
-          else
-            {
-              if (value[1] && b->type == YAD_PROGRESS_PULSE)
-                gtk_progress_bar_pulse (pb);
-              else if (value[1] && b->type == YAD_PROGRESS_CPULSE)
-                continue; /* just skip */
-              else if (value[1] && b->type == YAD_PROGRESS_PERM)
-                {
-                  guint id;
-
-                  if (strncmp (value[1], "start", 5) == 0)
-                    {
-                      id = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (pb), "id"));
-                      if (id == 0)
-                        {
-                          id = g_timeout_add (100, (GSourceFunc) pulsate_progress_bar, pb);
-                          g_object_set_data (G_OBJECT (pb), "id", GINT_TO_POINTER (id));
-                        }
-                    }
-                  else if (strncmp (value[1], "stop", 4) == 0)
-                    {
-                      id = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (pb), "id"));
-                      if (id > 0)
-                        {
-                          g_source_remove (id);
-                          g_object_set_data (G_OBJECT (pb), "id", GINT_TO_POINTER (0));
-                        }
-                    }
-                }
-              else
-                {
-                  if (!value[1] || !g_ascii_isdigit (*value[1]))
-                    continue;
-
-                  /* Now try to convert the thing to a number */
-                  percentage = atoi (value[1]);
-                  if (percentage >= 100)
-                    gtk_progress_bar_set_fraction (pb, 1.0);
-                  else
-                    gtk_progress_bar_set_fraction (pb, percentage / 100.0);
-
-                  /* Check if all of progress bars reaches 100% */
-                  if (options.progress_data.autoclose && options.plug == -1)
-                    {
-                      guint i;
-                      gboolean close = TRUE;
-                      gboolean need_close = FALSE;
-
-                      if (options.progress_data.watch_bar > 0 && options.progress_data.watch_bar <= nbars)
-                        {
-                          GtkProgressBar *cpb = GTK_PROGRESS_BAR (g_slist_nth_data (progress_bars,
-                                                                                    options.progress_data.watch_bar - 1));
-
-                          need_close = TRUE;
-                          if (gtk_progress_bar_get_fraction (cpb) != 1.0)
-                            close = FALSE;
-                        }
-                      else
-                        {
-                          for (i = 0; i < nbars; i++)
-                            {
-                              GtkProgressBar *cpb = GTK_PROGRESS_BAR (g_slist_nth_data (progress_bars, i));
-                              YadProgressBar *cb = (YadProgressBar *) g_slist_nth_data (options.progress_data.bars, i);
-
-                              if (cb->type != YAD_PROGRESS_PULSE)
-                                {
-                                  need_close = TRUE;
-                                  if (gtk_progress_bar_get_fraction (cpb) != 1.0)
-                                    {
-                                      close = FALSE;
-                                      break;
-                                    }
-                                }
-                            }
-                        }
-
-                      if (need_close && close)
-                        yad_exit (options.data.def_resp);
-                    }
-                }
-            }
+  /* frame clock doesn't tick while the dialog is unmapped, e.g. hidden or not shown yet */
+  if (update_timer == 0 && !gtk_widget_get_mapped (progress_table))
+    update_timer = g_timeout_add (UPDATE_TIMEOUT, flush_updates_timeout, NULL);
+}
+
+static void
+mark_dirty (YadBar *b)
+{
+  if (!b->dirty)
+    {
+      b->dirty = TRUE;
+      g_ptr_array_add (dirty_bars, b);
+    }
+  schedule_update ();
+}
+
+/* parse control line. possible commands are "ADD label[:type]" and "DEL bar" */
+static void
+parse_control (gchar *str)
+{
+  if (bar_store && g_ascii_strncasecmp (str, "ADD ", 4) == 0)
+    {
+      YadProgressType type = YAD_PROGRESS_NORMAL;
+      gchar *t = strrchr (str + 4, ':');
+
+      if (t)
+        {
+          if (strcasecmp (t + 1, "NORM") == 0)
+            *t = '\0';
+          else if (strcasecmp (t + 1, "RTL") == 0)
+            type = YAD_PROGRESS_RTL;
+          else if (strcasecmp (t + 1, "PULSE") == 0)
+            type = YAD_PROGRESS_PULSE;
+          else if (strcasecmp (t + 1, "CPULSE") == 0)
+            type = YAD_PROGRESS_CPULSE;
+          else if (strcasecmp (t + 1, "PERM") == 0)
+            type = YAD_PROGRESS_PERM;
+          if (type != YAD_PROGRESS_NORMAL)
+            *t = '\0';
+        }
+      bar_add_row (bar_new (str + 4, type));
+    }
+  else if (bar_store && g_ascii_strncasecmp (str, "DEL ", 4) == 0)
+    {
+      YadBar *b = find_bar (str + 4);
+
+      if (b)
+        {
+          bar_remove (b);
+          schedule_update ();
         }
-      while (g_io_channel_get_buffer_condition (channel) == G_IO_IN);
-      g_string_free (string, TRUE);
+    }
+  else if (options.debug)
+    g_printerr (_("yad_progress: invalid control line '%s'\n"), str);
+}
+
+/* raw is TRUE for values which must not be unescaped. only the latest value of each bar is kept
+   until the next frame */
+static void
+parse_line (gchar *str, gboolean raw)
+{
+  gchar **value;
+  YadBar *b;
+
+  /* control line if ^K received */
+  if (str[0] == '\013' && !single_mode)
+    {
+      parse_control (str + 1);
+      return;
+    }
+
+  if (single_mode)
+    {
+      value = g_new0 (gchar *, 3);
+      value[0] = g_strdup ("");
+      value[1] = g_strdup (str);
+      b = g_ptr_array_index (bars, 0);
+    }
+  else
+    {
+      value = g_strsplit (str, ":", 2);
+      b = find_bar (value[0]);
     }
 
-  if ((condition != G_IO_IN) && (condition != G_IO_IN + G_IO_HUP))
+  if (b == NULL || value[1] == NULL)
     {
-      g_io_channel_shutdown (channel, TRUE, NULL);
+      g_strfreev (value);
+      return;
+    }
 
-      if (options.progress_data.autoclose && options.plug == -1)
-         yad_exit (options.data.def_resp);
+  if (value[1][0] == '#')
+    {
+      gchar *match;
 
-      return FALSE;
+      /* We have a comment, so let's try to change the label */
+      match = raw ? g_strdup (value[1] + 1) : g_strcompress (value[1] + 1);
+      strip_new_line (match);
+      if (options.progress_data.log)
+        {
+          g_ptr_array_add (log_lines, g_strdup_printf ("%s\n", match));    /* add new line */
+          schedule_update ();
+        }
+      else if (!options.common_data.hide_text)
+        {
+          g_free (b->new_text);
+          b->new_text = match;
+          match = NULL;
+          mark_dirty (b);
+        }
+      g_free (match);
+    }
+  else if (b->type == YAD_PROGRESS_PULSE)
+    {
+      b->new_pulse = TRUE;
+      mark_dirty (b);
+    }
+  else if (b->type == YAD_PROGRESS_CPULSE)
+    ; /* just skip */
+  else if (b->type == YAD_PROGRESS_PERM)
+    {
+      if (strncmp (value[1], "start", 5) == 0)
+        {
+          if (b->timer == 0)
+            b->timer = g_timeout_add (100, (GSourceFunc) pulsate_progress_bar, b);
+        }
+      else if (strncmp (value[1], "stop", 4) == 0)
+        {
+          if (b->timer > 0)
+            {
+              g_source_remove (b->timer);
+              b->timer = 0;
+            }
+        }
+    }
+  else if (g_ascii_isdigit (*value[1]))
+    {
+      /* Now try to convert the thing to a number */
+      gint percentage = atoi (value[1]);
+      b->new_fraction = MIN (percentage, 100) / 100.0;
+      mark_dirty (b);
     }
+
+  g_strfreev (value);
+}
+
+static gboolean
+stdin_record_cb (gchar *str, gsize len, gpointer data)
+{
+  /* values in lines format are escaped */
+  parse_line (str, options.common_data.input_fmt != YAD_INPUT_LINES);
   return TRUE;
 }
 
+static void
+stdin_done (gpointer data)
+{
+  if (options.progress_data.autoclose && options.plug == -1)
+    yad_exit (options.data.def_resp);
+}
+
+static GtkWidget *
+create_bars_list ()
+{
+  GtkWidget *sw, *tv;
+  GtkCellRenderer *r;
+  GtkTreeViewColumn *col;
+
+  bar_store = gtk_list_store_new (BAR_N_COLS, G_TYPE_STRING, G_TYPE_INT, G_TYPE_STRING, G_TYPE_INT, G_TYPE_BOOLEAN);
+
+  tv = gtk_tree_view_new_with_model (GTK_TREE_MODEL (bar_store));
+  g_object_unref (bar_store);
+  gtk_widget_set_name (tv, "yad-progress-list");
+  gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (tv), FALSE);
+  gtk_tree_view_set_search_column (GTK_TREE_VIEW (tv), BAR_COL_NAME);
+
+  r = gtk_cell_renderer_text_new ();
+  g_object_set (G_OBJECT (r), "xalign", options.common_data.align, NULL);
+  col = gtk_tree_view_column_new_with_attributes (NULL, r, options.data.no_markup ? "text" : "markup",
+                                                  BAR_COL_NAME, NULL);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (tv), col);
+
+  r = gtk_cell_renderer_progress_new ();
+  col = gtk_tree_view_column_new_with_attributes (NULL, r, "value", BAR_COL_VALUE, "text", BAR_COL_TEXT,
+                                                  "pulse", BAR_COL_PULSE, "inverted", BAR_COL_INVERTED, NULL);
+  gtk_tree_view_column_set_expand (col, TRUE);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (tv), col);
+
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (sw), GTK_SHADOW_ETCHED_IN);
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw), options.data.hscroll_policy, options.data.vscroll_policy);
+  gtk_scrolled_window_set_propagate_natural_height (GTK_SCROLLED_WINDOW (sw), TRUE);
+  gtk_scrolled_window_set_max_content_height (GTK_SCROLLED_WINDOW (sw), PROGRESS_LIST_HEIGHT);
+  gtk_container_add (GTK_CONTAINER (sw), tv);
+  gtk_widget_set_hexpand (sw, TRUE);
+  gtk_widget_set_vexpand (sw, TRUE);
+
+  return sw;
+}
+
 GtkWidget *
 progress_create_widget (GtkWidget *dlg)
 {
   GtkWidget *table, *w = NULL;
-  GIOChannel *channel;
-  GSList *b;
-  gint i = 0;
+  GSList *l;
+  guint i = 0;
 
-  nbars = g_slist_length (options.progress_data.bars);
-  if (nbars < 1)
+  if (options.progress_data.bars == NULL)
     {
       YadProgressBar *bar = g_new0 (YadProgressBar, 1);
 
@@ -264,99 +532,116 @@ progress_create_widget (GtkWidget *dlg)
         bar->name = options.progress_data.progress_text;
 
       options.progress_data.bars = g_slist_append (options.progress_data.bars, bar);
-      nbars = 1;
 
       options.progress_data.watch_bar = 1;
 
       single_mode = TRUE;
     }
 
-  table = gtk_grid_new ();
+  bars = g_ptr_array_new ();
+  bar_names = g_hash_table_new (g_str_hash, g_str_equal);
+  dirty_bars = g_ptr_array_new ();
+
+  table = progress_table = gtk_grid_new ();
   gtk_grid_set_row_spacing (GTK_GRID (table), 2);
   gtk_grid_set_column_spacing (GTK_GRID (table), 2);
 
-  if (options.common_data.scroll)
+  if (options.progress_data.list_view && !single_mode)
     {
-      GtkWidget *sw = gtk_scrolled_window_new (NULL, NULL);
-      gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (sw), GTK_SHADOW_NONE);
-      gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw), options.data.hscroll_policy, options.data.vscroll_policy);
-      gtk_container_add (GTK_CONTAINER (sw), table);
-      w = sw;
+      /* bars are rows of list, so dialog can show hundreds of them */
+      gtk_grid_attach (GTK_GRID (table), create_bars_list (), 0, 0, 2, 1);
+      w = table;
+      i = 1;
+
+      for (l = options.progress_data.bars; l; l = l->next)
+        {
+          YadProgressBar *p = (YadProgressBar *) l->data;
+          YadBar *b = bar_new (p->name, p->type);
+
+          bar_add_row (b);
+          /* list has no pulse step, so extra data is ignored for pulsating bars */
+          if (options.extra_data && options.extra_data[bars->len - 1] &&
+              g_ascii_isdigit (*options.extra_data[bars->len - 1]) &&
+              p->type != YAD_PROGRESS_PULSE && p->type != YAD_PROGRESS_CPULSE)
+            bar_set_fraction (b, MIN (atoi (options.extra_data[bars->len - 1]), 100) / 100.0);
+        }
     }
   else
-    w = table;
-
-  for (b = options.progress_data.bars; b; b = b->next)
     {
-      GtkWidget *l, *w;
-      YadProgressBar *p = (YadProgressBar *) b->data;
-
-      /* add label */
-      l = gtk_label_new (NULL);
-      if (options.data.no_markup)
-        gtk_label_set_text (GTK_LABEL (l), p->name);
+      if (options.common_data.scroll)
+        {
+          GtkWidget *sw = gtk_scrolled_window_new (NULL, NULL);
+          gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (sw), GTK_SHADOW_NONE);
+          gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw), options.data.hscroll_policy, options.data.vscroll_policy);
+          gtk_container_add (GTK_CONTAINER (sw), table);
+          w = sw;
+        }
       else
-        gtk_label_set_markup (GTK_LABEL (l), p->name);
-      gtk_label_set_xalign (GTK_LABEL (l), options.common_data.align);
+        w = table;
 
-      if (options.common_data.vertical)
-        gtk_grid_attach (GTK_GRID (table), l, i, 1, 1, 1);
-      else
-        gtk_grid_attach (GTK_GRID (table), l, 0, i, 1, 1);
+      for (l = options.progress_data.bars; l; l = l->next)
+        {
+          GtkWidget *lb, *pb;
+          YadProgressBar *p = (YadProgressBar *) l->data;
+          YadBar *b = bar_new (p->name, p->type);
+
+          /* add label */
+          lb = gtk_label_new (NULL);
+          if (options.data.no_markup)
+            gtk_label_set_text (GTK_LABEL (lb), p->name);
+          else
+            gtk_label_set_markup (GTK_LABEL (lb), p->name);
+          gtk_label_set_xalign (GTK_LABEL (lb), options.common_data.align);
+
+          if (options.common_data.vertical)
+            gtk_grid_attach (GTK_GRID (table), lb, i, 1, 1, 1);
+          else
+            gtk_grid_attach (GTK_GRID (table), lb, 0, i, 1, 1);
 
-      /* add progress bar */
-      w = gtk_progress_bar_new ();
-      gtk_widget_set_name (w, "yad-progress-widget");
-      gtk_progress_bar_set_show_text (GTK_PROGRESS_BAR (w), !options.common_data.hide_text);
+          /* add progress bar */
+          pb = b->bar = gtk_progress_bar_new ();
+          gtk_widget_set_name (pb, "yad-progress-widget");
+          gtk_progress_bar_set_show_text (GTK_PROGRESS_BAR (pb), !options.common_data.hide_text);
 
-      if (p->type != YAD_PROGRESS_PULSE || p->type != YAD_PROGRESS_CPULSE)
-        {
-          if (options.extra_data && options.extra_data[i])
+          if (options.extra_data && options.extra_data[i] && g_ascii_isdigit (*options.extra_data[i]))
             {
-              if (g_ascii_isdigit (*options.extra_data[i]))
-                gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (w), atoi (options.extra_data[i]) / 100.0);
+              if (p->type != YAD_PROGRESS_PULSE && p->type != YAD_PROGRESS_CPULSE)
+                bar_set_fraction (b, MIN (atoi (options.extra_data[i]), 100) / 100.0);
+              else
+                gtk_progress_bar_set_pulse_step (GTK_PROGRESS_BAR (pb), atoi (options.extra_data[i]) / 100.0);
             }
-        }
-      else
-        {
-          if (options.extra_data && options.extra_data[i])
+
+          gtk_progress_bar_set_inverted (GTK_PROGRESS_BAR (pb), p->type == YAD_PROGRESS_RTL);
+
+          if (options.common_data.vertical)
             {
-              if (g_ascii_isdigit (*options.extra_data[i]))
-                gtk_progress_bar_set_pulse_step (GTK_PROGRESS_BAR (w), atoi (options.extra_data[i]) / 100.0);
+              gtk_orientable_set_orientation (GTK_ORIENTABLE (pb), GTK_ORIENTATION_VERTICAL);
+              gtk_grid_attach (GTK_GRID (table), pb, i, 0, 1, 1);
+              gtk_widget_set_vexpand (pb, TRUE);
+            }
+          else
+            {
+              gtk_grid_attach (GTK_GRID (table), pb, 1, i, 1, 1);
+              gtk_widget_set_hexpand (pb, TRUE);
             }
-        }
 
-      gtk_progress_bar_set_inverted (GTK_PROGRESS_BAR (w), p->type == YAD_PROGRESS_RTL);
+          if (p->type == YAD_PROGRESS_CPULSE)
+            b->timer = g_timeout_add_seconds (1, (GSourceFunc) pulsate_progress_bar, b);
 
-      if (options.common_data.vertical)
-        {
-          gtk_orientable_set_orientation (GTK_ORIENTABLE (w), GTK_ORIENTATION_VERTICAL);
-          gtk_grid_attach (GTK_GRID (table), w, i, 0, 1, 1);
-          gtk_widget_set_vexpand (w, TRUE);
+          i++;
         }
-      else
-        {
-          gtk_grid_attach (GTK_GRID (table), w, 1, i, 1, 1);
-          gtk_widget_set_hexpand (w, TRUE);
-        }
-
-      progress_bars = g_slist_append (progress_bars, w);
-      
-      if (p->type == YAD_PROGRESS_CPULSE)
-        g_timeout_add_seconds (1, (GSourceFunc) pulsate_progress_bar, w);
-
-      i++;
     }
 
   if (options.progress_data.log)
     {
       GtkWidget *ex, *sw;
+      GtkTextIter end;
 
       ex = gtk_expander_new (options.progress_data.log);
       gtk_expander_set_spacing (GTK_EXPANDER (ex), 2);
       gtk_expander_set_expanded (GTK_EXPANDER (ex), options.progress_data.log_expanded);
 
-      if (options.common_data.vertical)
+      if (options.common_data.vertical && !bar_store)
         gtk_grid_attach (GTK_GRID (table), ex, 0, 2, i, 1);
       else
         gtk_grid_attach (GTK_GRID (table), ex, 0, i, 2, 1);
@@ -378,12 +663,13 @@ progress_create_widget (GtkWidget *dlg)
       gtk_text_view_set_right_margin (GTK_TEXT_VIEW (progress_log), 5);
       gtk_text_view_set_editable (GTK_TEXT_VIEW (progress_log), FALSE);
       gtk_text_view_set_cursor_visible (GTK_TEXT_VIEW (progress_log), FALSE);
+
+      gtk_text_buffer_get_end_iter (log_buffer, &end);
+      log_end = gtk_text_buffer_create_mark (log_buffer, NULL, &end, FALSE);
+      log_lines = g_ptr_array_new_with_free_func (g_free);
     }
 
-  channel = g_io_channel_unix_new (0);
-  g_io_channel_set_encoding (channel, NULL, NULL);
-  g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
-  g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, dlg);
+  yad_read_records (0, stdin_record_cb, stdin_done, dlg);
 
   return w;
 }
@@ -183,5 +183,6 @@ scale_create_widget (GtkWidget * dlg)
 void
 scale_print_result (void)
 {
-  g_print ("%.0f\n", gtk_range_get_value (GTK_RANGE (scale)));
+  yad_output_double (gtk_range_get_value (GTK_RANGE (scale)), 0, FALSE);
+  yad_output_row_end (FALSE);
 }
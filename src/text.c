@@ -17,93 +17,183 @@
  * Copyright (C) 2008-2025, Victor Ananjevsky <victor@sanana.kiev.ua>
  */
 
+#include <unistd.h>
 #include <pango/pango.h>
 
 #include "yad.h"
 
+/* size of one read from stdin */
+#define TEXT_READ_CHUNK (64 * 1024)
+/* maximum size of data read from stdin in one main loop iteration */
+#define TEXT_READ_MAX (1024 * 1024)
+/* delay between insertions of stdin data (about one frame) */
+#define TEXT_FLUSH_DELAY 16
+/* maximum size of stdin data used for guessing language */
+#define TEXT_GUESS_MAX (64 * 1024)
+/* number of lines kept in buffer in pager mode and step of moving this window */
+#define PAGER_LINES 2000
+#define PAGER_STEP (PAGER_LINES / 4)
+/* size of file block indexed at once */
+#define PAGER_BLOCK (4 * 1024 * 1024)
+/* size of file beginning used for detecting of charset */
+#define PAGER_DETECT_SIZE (64 * 1024)
+/* size of chunks for reading and writing files (in bytes for reading and in characters for writing) */
+#define FILE_OP_CHUNK (64 * 1024)
+/* size of text block matched at once in searching */
+#define TEXT_SCAN_BLOCK (1024 * 1024)
+/* number of lines checked for links in one main loop iteration */
+#define LINKIFY_SLICE 500
+/* maximum number of parameters in ansi escape sequence */
+#define ANSI_MAX_PARAMS 16
+
 static GtkWidget *text_view;
 static GObject *text_buffer;
 static GtkTextTag *tag;
 static GdkCursor *hand, *normal;
+static GRegex *link_re = NULL;
+static GtkTextMark *link_start = NULL, *link_end = NULL;
+static guint link_id = 0;
 static YadSearchBar *search_bar = NULL;
 static GtkTextIter match_start, match_end;
 static gboolean text_changed = FALSE;
+static gboolean goto_pending = FALSE;
 static gboolean search_changed = FALSE;
 
-/* searching */
-static void
-do_find_next (GtkWidget *w, gpointer d)
-{
-  GtkTextIter search_pos;
-  GtkTextSearchFlags sflags;
-
-  if (search_bar->case_sensitive)
-    sflags = GTK_TEXT_SEARCH_TEXT_ONLY;
-  else
-    sflags = GTK_TEXT_SEARCH_TEXT_ONLY | GTK_TEXT_SEARCH_CASE_INSENSITIVE;
-
-  if (search_bar->new_search)
-    {
-      gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (text_buffer), &search_pos,
-                                        gtk_text_buffer_get_insert (GTK_TEXT_BUFFER (text_buffer)));
-    }
-  else
-    search_pos = match_end;
-
-  if (gtk_text_iter_forward_search (&search_pos, search_bar->str, sflags, &match_start, &match_end, NULL))
-    {
-      gtk_text_view_scroll_to_iter (GTK_TEXT_VIEW (text_view), &match_start, 0.0, FALSE, 0.0, 0.0);
-      gtk_text_buffer_select_range (GTK_TEXT_BUFFER (text_buffer), &match_start, &match_end);
-      search_changed = TRUE;
-    }
-
-  search_bar->new_search = FALSE;
-}
-
-static void
-do_find_prev (GtkWidget *w, gpointer d)
-{
-  GtkTextIter search_pos;
-  GtkTextSearchFlags sflags;
-
-  if (search_bar->case_sensitive)
-    sflags = GTK_TEXT_SEARCH_TEXT_ONLY;
-  else
-    sflags = GTK_TEXT_SEARCH_TEXT_ONLY | GTK_TEXT_SEARCH_CASE_INSENSITIVE;
-
-  search_pos = match_start;
-  if (gtk_text_iter_backward_search (&search_pos, search_bar->str, sflags, &match_start, &match_end, NULL))
-    {
-      gtk_text_view_scroll_to_iter (GTK_TEXT_VIEW (text_view), &match_start, 0.0, FALSE, 0.0, 0.0);
-      gtk_text_buffer_select_range (GTK_TEXT_BUFFER (text_buffer), &match_start, &match_end);
-      search_changed = TRUE;
-    }
-}
-
-static void
-search_changed_cb (GtkWidget *w, gpointer d)
-{
-  search_bar->new_search = TRUE;
-  search_bar->str = gtk_entry_get_text (GTK_ENTRY (search_bar->entry));
-  do_find_next (NULL, NULL);
-}
-
-static void
-stop_search_cb (GtkWidget *w, YadSearchBar *sb)
-{
-  ignore_esc = FALSE;
-  gtk_search_bar_set_search_mode (GTK_SEARCH_BAR (search_bar->bar), FALSE);
-  gtk_widget_grab_focus (text_view);
-  if (search_changed)
-    {
-      gtk_text_iter_backward_char (&match_start);
-      gtk_text_buffer_place_cursor (GTK_TEXT_BUFFER (text_buffer), &match_start);
-    }
-  search_changed = FALSE;
-}
+/* found matches. position is in characters for buffer and in bytes for pager */
+typedef struct {
+  gsize off;
+  gint len;
+  glong pos;
+  glong chars;
+} YadTextHit;
+
+/* search in a snapshot of text. in pager mode mapped file is searched */
+typedef struct {
+  GRegex *re;
+  gchar *text;
+  GMappedFile *map;
+  const gchar *data;
+  gsize len;
+  GMutex lock;
+  GArray *hits;
+} YadTextScan;
+
+static GTask *scan_task = NULL;
+static GCancellable *scan_cancel = NULL;
+static guint scan_timer = 0;
+static gboolean scan_done = FALSE;
+static gboolean scan_dirty = FALSE;
+static GArray *hits = NULL;
+static gint cur_hit = -1;
+/* jump to the first match after this position when it will be found */
+static gint64 want_hit = -1;
+static GtkTextTag *hit_tag = NULL;
+static GtkTextMark *hl_start = NULL, *hl_end = NULL;
+
+/* current reading or saving of file */
+typedef struct {
+  GFile *file;
+  GInputStream *in;
+  GOutputStream *out;
+  GCancellable *cancel;
+  gboolean saving;
+  goffset size;
+  goffset done;
+  /* decoded data waiting for insertion */
+  YadDecoder *dec;
+  GString *rest;
+  /* slice of text which is written now */
+  gchar *data;
+  /* position of reading or writing in buffer */
+  GtkTextMark *pos;
+} YadFileOp;
+
+static YadFileOp *file_op = NULL;
+/* last loading was cancelled or failed, so buffer has only a part of the file */
+static gboolean load_incomplete = FALSE;
+static GtkWidget *op_box, *op_bar;
+
+/* stdin data waiting for insertion */
+static GString *pending_text = NULL;
+static GtkTextMark *end_mark = NULL;
+static guint flush_id = 0;
+static gboolean stdin_eof = FALSE;
+static YadDecoder *stdin_dec = NULL;
+#ifdef HAVE_SOURCEVIEW
+static GString *guess_data = NULL;
+#endif
 
-/* early prototype for use in open_file_cb() */
+/* line index of mapped file for pager mode. it is filled by separate thread */
+typedef struct {
+  GMappedFile *map;
+  const gchar *data;
+  gsize len;
+  GThread *thread;
+  GMutex lock;
+  gsize *offs;
+  guint n_offs;
+  guint size;
+  gboolean done;
+  gint cancel;
+  /* pages are decoded separately, but charset is detected once */
+  YadDecoder *dec;
+} YadPagerIndex;
+
+static YadPagerIndex *pager = NULL;
+/* window of lines in buffer */
+static guint pg_start = 0;
+static guint pg_count = 0;
+static gboolean pg_busy = FALSE;
+static guint pg_timer = 0;
+static GtkTextMark *pg_mark = NULL;
+/* delayed jumps to the positions which are not indexed yet */
+static gint64 pg_goto_line = -1;
+static gssize pg_goto_off = -1;
+static gint pg_goto_len = 0;
+
+/* ansi sgr rendering. colors are palette indexes or rgb values with ANSI_RGB flag */
+#define ANSI_DEFAULT -1
+#define ANSI_RGB 0x1000000
+#define ANSI_BG 0x2000000
+
+enum {
+  ANSI_TEXT,
+  ANSI_ESC,
+  ANSI_ESC_INTER,
+  ANSI_CSI,
+  ANSI_OSC,
+  ANSI_OSC_ESC
+};
+
+enum {
+  ANSI_BOLD,
+  ANSI_DIM,
+  ANSI_ITALIC,
+  ANSI_UNDERLINE,
+  ANSI_STRIKE,
+  ANSI_REVERSE,
+  ANSI_N_ATTRS
+};
+
+typedef struct {
+  gint fg;
+  gint bg;
+  guint attrs;
+} YadAnsiState;
+
+static YadAnsiState ansi_cur = { ANSI_DEFAULT, ANSI_DEFAULT, 0 };
+static gint ansi_mode = ANSI_TEXT;
+static gint ansi_params[ANSI_MAX_PARAMS];
+static guint ansi_n_params = 0;
+static gboolean ansi_skip = FALSE;
+static GtkTextTag *ansi_tags[ANSI_N_ATTRS];
+static GHashTable *ansi_colors = NULL;
+/* text with the same attributes waiting for insertion */
+static GString *ansi_run = NULL;
+
+/* early prototypes for use in file operations */
 static void fill_buffer_from_file ();
+static void save_text (gboolean wait);
 
 /* file operations */
 static void
@@ -112,6 +202,10 @@ open_file_cb (GtkWidget *w, gpointer d)
   GtkWidget *dlg;
   static gchar *dir = NULL;
 
+  /* buffer and file name must not be changed while file is loaded or saved */
+  if (file_op)
+    return;
+
   if (!dir && options.common_data.uri)
     dir = g_path_get_dirname (options.common_data.uri);
 
@@ -131,15 +225,13 @@ open_file_cb (GtkWidget *w, gpointer d)
         g_free (options.common_data.uri);
       options.common_data.uri = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dlg));
 
-      /* load file */
+      /* load file. text_changed is reset after loading */
       gtk_text_buffer_set_text (GTK_TEXT_BUFFER (text_buffer), "", -1);
       fill_buffer_from_file ();
 
       /* keep current dir */
       g_free (dir);
       dir = gtk_file_chooser_get_current_folder (GTK_FILE_CHOOSER (dlg));
-
-      text_changed = FALSE;
     }
 
   gtk_widget_destroy (dlg);
@@ -148,33 +240,7 @@ open_file_cb (GtkWidget *w, gpointer d)
 static void
 save_file_cb (GtkWidget *w, gpointer d)
 {
-  GtkTextIter start, end;
-  gchar *text;
-  GStatBuf st;
-  gint mode = -1;
-  GError *err = NULL;
-
-  gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (text_buffer), &start, &end);
-  text = gtk_text_buffer_get_text (GTK_TEXT_BUFFER (text_buffer), &start, &end, 0);
-
-  /* g_file_set_contents changes the file permissions. so it must be kept and restored after file saving */
-  if (g_stat (options.common_data.uri, &st) == 0)
-    mode = st.st_mode;
-
-  if (!g_file_set_contents (options.common_data.uri, text, -1, &err))
-    {
-      g_printerr ("Cannot save file %s: %s\n", options.common_data.uri, err->message);
-      g_error_free (err);
-    }
-  else
-    {
-      /* restore permissions */
-      if (mode != -1)
-        g_chmod (options.common_data.uri, mode);
-      text_changed = FALSE;
-    }
-
-  g_free (text);
+  save_text (FALSE);
 }
 
 static void
@@ -183,6 +249,10 @@ save_as_file_cb (GtkWidget *w, gpointer d)
   GtkWidget *dlg;
   static gchar *dir = NULL;
 
+  /* buffer and file name must not be changed while file is loaded or saved */
+  if (file_op)
+    return;
+
   if (!dir && options.common_data.uri)
     dir = g_path_get_dirname (options.common_data.uri);
 
@@ -209,6 +279,8 @@ save_as_file_cb (GtkWidget *w, gpointer d)
       if (options.common_data.uri)
         g_free (options.common_data.uri);
       options.common_data.uri = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dlg));
+      /* user explicitly saves what is in the buffer */
+      load_incomplete = FALSE;
       save_file_cb (w, d);
 
       /* keep current dir */
@@ -246,13 +318,14 @@ menu_popup_cb (GtkTextView *w, GtkWidget *popup, gpointer d)
           gtk_menu_shell_prepend (GTK_MENU_SHELL (popup), mitem);
           g_signal_connect (G_OBJECT (mitem), "activate", G_CALLBACK (save_as_file_cb), NULL);
           gtk_widget_show (mitem);
+          gtk_widget_set_sensitive (mitem, file_op == NULL);
 
           mitem = gtk_menu_item_new_with_mnemonic (_("_Save"));
           gtk_menu_shell_prepend (GTK_MENU_SHELL (popup), mitem);
           g_signal_connect (G_OBJECT (mitem), "activate", G_CALLBACK (save_file_cb), NULL);
           gtk_widget_show (mitem);
 
-          if (!options.common_data.uri)
+          if (!options.common_data.uri || file_op)
             gtk_widget_set_sensitive (mitem, FALSE);
         }
 
@@ -260,6 +333,7 @@ menu_popup_cb (GtkTextView *w, GtkWidget *popup, gpointer d)
       gtk_menu_shell_prepend (GTK_MENU_SHELL (popup), mitem);
       g_signal_connect (G_OBJECT (mitem), "activate", G_CALLBACK (open_file_cb), NULL);
       gtk_widget_show (mitem);
+      gtk_widget_set_sensitive (mitem, file_op == NULL);
 
       /* at bootom */
       mitem = gtk_separator_menu_item_new ();
@@ -384,34 +458,42 @@ motion_cb (GtkWidget * w, GdkEventMotion * ev, gpointer d)
   return FALSE;
 }
 
+/* links are searched only in changed lines. changed region is kept between marks
+   and processed in idle by slices */
 static void
-linkify_cb (GtkTextBuffer * buf, GRegex * regex)
+linkify_slice (GtkTextBuffer *buf, GtkTextIter *start, GtkTextIter *end)
 {
   gchar *text;
-  GtkTextIter start, end;
   GMatchInfo *match;
+  gint offset;
 
-  gtk_text_buffer_get_bounds (buf, &start, &end);
-  text = gtk_text_buffer_get_text (buf, &start, &end, FALSE);
+  text = gtk_text_buffer_get_text (buf, start, end, FALSE);
+  offset = gtk_text_iter_get_offset (start);
 
-  gtk_text_buffer_remove_all_tags (buf, &start, &end);
+  gtk_text_buffer_remove_tag (buf, tag, start, end);
 
-  if (g_regex_match (regex, text, G_REGEX_MATCH_NOTEMPTY, &match))
+  if (g_regex_match (link_re, text, G_REGEX_MATCH_NOTEMPTY, &match))
     {
+      const gchar *p = text;
+      gint pos = 0;
+
       do
         {
+          GtkTextIter ms, me;
           gint sp, ep, spos, epos;
 
           g_match_info_fetch_pos (match, 0, &sp, &ep);
 
-          /* positions are in bytes, not character, so here we must normalize it */
-          spos = g_utf8_pointer_to_offset (text, text + sp);
-          epos = g_utf8_pointer_to_offset (text, text + ep);
-
-          gtk_text_buffer_get_iter_at_offset (buf, &start, spos);
-          gtk_text_buffer_get_iter_at_offset (buf, &end, epos);
+          /* positions are in bytes, not character, so here we must normalize it.
+             matches are ordered, so counting continues from the previous one */
+          spos = pos + g_utf8_pointer_to_offset (p, text + sp);
+          epos = spos + g_utf8_pointer_to_offset (text + sp, text + ep);
+          p = text + ep;
+          pos = epos;
 
-          gtk_text_buffer_apply_tag (buf, tag, &start, &end);
+          gtk_text_buffer_get_iter_at_offset (buf, &ms, offset + spos);
+          gtk_text_buffer_get_iter_at_offset (buf, &me, offset + epos);
+          gtk_text_buffer_apply_tag (buf, tag, &ms, &me);
         }
       while (g_match_info_next (match, NULL));
     }
@@ -420,6 +502,87 @@ linkify_cb (GtkTextBuffer * buf, GRegex * regex)
   g_free (text);
 }
 
+static gboolean
+linkify_idle (gpointer data)
+{
+  GtkTextBuffer *buf = GTK_TEXT_BUFFER (text_buffer);
+  GtkTextIter start, end, last;
+
+  gtk_text_buffer_get_iter_at_mark (buf, &start, link_start);
+  gtk_text_buffer_get_iter_at_mark (buf, &last, link_end);
+
+  end = start;
+  gtk_text_iter_forward_lines (&end, LINKIFY_SLICE);
+  if (gtk_text_iter_compare (&end, &last) > 0)
+    {
+      end = last;
+      if (!gtk_text_iter_ends_line (&end))
+        gtk_text_iter_forward_to_line_end (&end);
+    }
+
+  linkify_slice (buf, &start, &end);
+
+  if (gtk_text_iter_compare (&end, &last) >= 0)
+    {
+      gtk_text_buffer_delete_mark (buf, link_start);
+      gtk_text_buffer_delete_mark (buf, link_end);
+      link_start = link_end = NULL;
+      link_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  gtk_text_buffer_move_mark (buf, link_start, &end);
+  return G_SOURCE_CONTINUE;
+}
+
+/* add lines from start to end to the changed region */
+static void
+linkify_add (GtkTextBuffer *buf, GtkTextIter *start, GtkTextIter *end)
+{
+  GtkTextIter s = *start, e = *end;
+
+  gtk_text_iter_set_line_offset (&s, 0);
+  if (!gtk_text_iter_ends_line (&e))
+    gtk_text_iter_forward_to_line_end (&e);
+
+  if (link_start == NULL)
+    {
+      link_start = gtk_text_buffer_create_mark (buf, NULL, &s, TRUE);
+      link_end = gtk_text_buffer_create_mark (buf, NULL, &e, FALSE);
+    }
+  else
+    {
+      GtkTextIter ls, le;
+
+      gtk_text_buffer_get_iter_at_mark (buf, &ls, link_start);
+      gtk_text_buffer_get_iter_at_mark (buf, &le, link_end);
+      if (gtk_text_iter_compare (&s, &ls) < 0)
+        gtk_text_buffer_move_mark (buf, link_start, &s);
+      if (gtk_text_iter_compare (&e, &le) > 0)
+        gtk_text_buffer_move_mark (buf, link_end, &e);
+    }
+
+  if (link_id == 0)
+    link_id = g_idle_add (linkify_idle, NULL);
+}
+
+static void
+linkify_insert_cb (GtkTextBuffer *buf, GtkTextIter *pos, gchar *text, gint len, gpointer d)
+{
+  GtkTextIter start = *pos;
+
+  /* handler is called after insertion, so pos is at the end of new text */
+  gtk_text_iter_backward_chars (&start, g_utf8_strlen (text, len));
+  linkify_add (buf, &start, pos);
+}
+
+static void
+linkify_delete_cb (GtkTextBuffer *buf, GtkTextIter *start, GtkTextIter *end, gpointer d)
+{
+  /* link may be broken at the place of deleted text */
+  linkify_add (buf, start, end);
+}
+
 #if HAVE_SOURCEVIEW
 static void
 line_mark_activated (GtkSourceGutter *gutter, GtkTextIter *iter, GdkEventButton *ev, gpointer d)
@@ -447,194 +610,1739 @@ line_mark_activated (GtkSourceGutter *gutter, GtkTextIter *iter, GdkEventButton
 }
 #endif
 
-/* data loading */
-static gboolean
-handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
+static void
+ansi_init ()
+{
+  GtkTextBuffer *buf = GTK_TEXT_BUFFER (text_buffer);
+
+  ansi_tags[ANSI_BOLD] = gtk_text_buffer_create_tag (buf, NULL, "weight", PANGO_WEIGHT_BOLD, NULL);
+  ansi_tags[ANSI_DIM] = gtk_text_buffer_create_tag (buf, NULL, "weight", PANGO_WEIGHT_LIGHT, NULL);
+  ansi_tags[ANSI_ITALIC] = gtk_text_buffer_create_tag (buf, NULL, "style", PANGO_STYLE_ITALIC, NULL);
+  ansi_tags[ANSI_UNDERLINE] = gtk_text_buffer_create_tag (buf, NULL, "underline", PANGO_UNDERLINE_SINGLE, NULL);
+  ansi_tags[ANSI_STRIKE] = gtk_text_buffer_create_tag (buf, NULL, "strikethrough", TRUE, NULL);
+  /* reverse video swaps colors and has no tag */
+  ansi_tags[ANSI_REVERSE] = NULL;
+
+  ansi_colors = g_hash_table_new (g_direct_hash, g_direct_equal);
+  ansi_run = g_string_new (NULL);
+}
+
+static void
+ansi_reset ()
+{
+  ansi_cur.fg = ansi_cur.bg = ANSI_DEFAULT;
+  ansi_cur.attrs = 0;
+  ansi_mode = ANSI_TEXT;
+}
+
+/* tags for colors are created on demand and never freed */
+static GtkTextTag *
+ansi_color_tag (gint color, gboolean bg)
 {
-  if ((condition & G_IO_IN) || (condition & (G_IO_IN | G_IO_HUP)))
+  /* xterm colors */
+  static const guchar base[16][3] = {
+    { 0x00, 0x00, 0x00 }, { 0xcd, 0x00, 0x00 }, { 0x00, 0xcd, 0x00 }, { 0xcd, 0xcd, 0x00 },
+    { 0x00, 0x00, 0xee }, { 0xcd, 0x00, 0xcd }, { 0x00, 0xcd, 0xcd }, { 0xe5, 0xe5, 0xe5 },
+    { 0x7f, 0x7f, 0x7f }, { 0xff, 0x00, 0x00 }, { 0x00, 0xff, 0x00 }, { 0xff, 0xff, 0x00 },
+    { 0x5c, 0x5c, 0xff }, { 0xff, 0x00, 0xff }, { 0x00, 0xff, 0xff }, { 0xff, 0xff, 0xff }
+  };
+  GtkTextTag *t;
+  gint key = color | (bg ? ANSI_BG : 0);
+  guint r, g, b;
+  gchar spec[8];
+
+  t = g_hash_table_lookup (ansi_colors, GINT_TO_POINTER (key));
+  if (t)
+    return t;
+
+  if (color & ANSI_RGB)
     {
-      GString *string;
-      GError *err = NULL;
-      gint status;
-#ifdef HAVE_SOURCEVIEW
-      GtkSourceLanguage *lang = NULL;
-#endif
+      r = (color >> 16) & 0xFF;
+      g = (color >> 8) & 0xFF;
+      b = color & 0xFF;
+    }
+  else if (color < 16)
+    {
+      r = base[color][0];
+      g = base[color][1];
+      b = base[color][2];
+    }
+  else if (color < 232)
+    {
+      /* 6x6x6 color cube */
+      color -= 16;
+      r = color / 36 ? 55 + (color / 36) * 40 : 0;
+      g = (color / 6) % 6 ? 55 + ((color / 6) % 6) * 40 : 0;
+      b = color % 6 ? 55 + (color % 6) * 40 : 0;
+    }
+  else
+    r = g = b = 8 + (color - 232) * 10;
 
-      string = g_string_new (NULL);
-      while (channel->is_readable != TRUE)
-        usleep (100);
+  g_snprintf (spec, sizeof (spec), "#%02x%02x%02x", r, g, b);
+  t = gtk_text_buffer_create_tag (GTK_TEXT_BUFFER (text_buffer), NULL,
+                                  bg ? "background" : "foreground", spec, NULL);
+  g_hash_table_insert (ansi_colors, GINT_TO_POINTER (key), t);
 
-      do
-        {
-          status = g_io_channel_read_line_string (channel, string, NULL, &err);
-          while (gtk_events_pending ())
-            gtk_main_iteration ();
-        }
-      while (status == G_IO_STATUS_AGAIN);
+  /* search highlighting must stay over the colors */
+  if (hit_tag)
+    {
+      GtkTextTagTable *tt = gtk_text_buffer_get_tag_table (GTK_TEXT_BUFFER (text_buffer));
+      gtk_text_tag_set_priority (hit_tag, gtk_text_tag_table_get_size (tt) - 1);
+    }
+
+  return t;
+}
+
+/* insert collected run of text and apply current attributes to it */
+static void
+ansi_flush (GtkTextIter *iter)
+{
+  GtkTextBuffer *buf = GTK_TEXT_BUFFER (text_buffer);
+  GtkTextIter start;
+  gint offset, fg, bg;
+  guint i;
+
+  if (ansi_run->len == 0)
+    return;
+
+  offset = gtk_text_iter_get_offset (iter);
+  gtk_text_buffer_insert (buf, iter, ansi_run->str, ansi_run->len);
+  g_string_truncate (ansi_run, 0);
+
+  fg = ansi_cur.fg;
+  bg = ansi_cur.bg;
+  if (ansi_cur.attrs & (1 << ANSI_REVERSE))
+    {
+      /* default colors are taken as black text on white background */
+      fg = (ansi_cur.bg == ANSI_DEFAULT) ? 15 : ansi_cur.bg;
+      bg = (ansi_cur.fg == ANSI_DEFAULT) ? 0 : ansi_cur.fg;
+    }
+
+  if (fg == ANSI_DEFAULT && bg == ANSI_DEFAULT && ansi_cur.attrs == 0)
+    return;
+
+  gtk_text_buffer_get_iter_at_offset (buf, &start, offset);
+  if (fg != ANSI_DEFAULT)
+    gtk_text_buffer_apply_tag (buf, ansi_color_tag (fg, FALSE), &start, iter);
+  if (bg != ANSI_DEFAULT)
+    gtk_text_buffer_apply_tag (buf, ansi_color_tag (bg, TRUE), &start, iter);
+  for (i = 0; i < ANSI_N_ATTRS; i++)
+    {
+      if (ansi_tags[i] && (ansi_cur.attrs & (1 << i)))
+        gtk_text_buffer_apply_tag (buf, ansi_tags[i], &start, iter);
+    }
+}
+
+/* parse extended color (38;5;N or 38;2;R;G;B). returns index of the last used parameter */
+static guint
+ansi_ext_color (guint i, gint *color)
+{
+  if (i + 2 <= ansi_n_params && ansi_params[i + 1] == 5)
+    {
+      *color = MIN (ansi_params[i + 2], 255);
+      return i + 2;
+    }
+  if (i + 4 <= ansi_n_params && ansi_params[i + 1] == 2)
+    {
+      *color = ANSI_RGB | (MIN (ansi_params[i + 2], 255) << 16) |
+        (MIN (ansi_params[i + 3], 255) << 8) | MIN (ansi_params[i + 4], 255);
+      return i + 4;
+    }
+  /* malformed sequence. ignore the rest of it */
+  return ansi_n_params;
+}
 
-      if (status != G_IO_STATUS_NORMAL)
+/* apply select graphic rendition sequence. text is split only if attributes are really changed */
+static void
+ansi_sgr (GtkTextIter *iter)
+{
+  YadAnsiState st = ansi_cur;
+  guint i;
+
+  for (i = 0; i <= ansi_n_params; i++)
+    {
+      gint v = ansi_params[i];
+
+      if (v == 0)
         {
-          if (err)
-            {
-              g_printerr ("yad_text_handle_stdin(): %s\n", err->message);
-              g_error_free (err);
-              err = NULL;
-            }
-          /* stop handling */
-          g_io_channel_shutdown (channel, TRUE, NULL);
-          return FALSE;
+          st.fg = st.bg = ANSI_DEFAULT;
+          st.attrs = 0;
         }
+      else if (v == 1)
+        st.attrs |= 1 << ANSI_BOLD;
+      else if (v == 2)
+        st.attrs |= 1 << ANSI_DIM;
+      else if (v == 3)
+        st.attrs |= 1 << ANSI_ITALIC;
+      else if (v == 4)
+        st.attrs |= 1 << ANSI_UNDERLINE;
+      else if (v == 7)
+        st.attrs |= 1 << ANSI_REVERSE;
+      else if (v == 9)
+        st.attrs |= 1 << ANSI_STRIKE;
+      else if (v == 22)
+        st.attrs &= ~((1 << ANSI_BOLD) | (1 << ANSI_DIM));
+      else if (v == 23)
+        st.attrs &= ~(1 << ANSI_ITALIC);
+      else if (v == 24)
+        st.attrs &= ~(1 << ANSI_UNDERLINE);
+      else if (v == 27)
+        st.attrs &= ~(1 << ANSI_REVERSE);
+      else if (v == 29)
+        st.attrs &= ~(1 << ANSI_STRIKE);
+      else if (v >= 30 && v <= 37)
+        st.fg = v - 30;
+      else if (v == 38)
+        i = ansi_ext_color (i, &st.fg);
+      else if (v == 39)
+        st.fg = ANSI_DEFAULT;
+      else if (v >= 40 && v <= 47)
+        st.bg = v - 40;
+      else if (v == 48)
+        i = ansi_ext_color (i, &st.bg);
+      else if (v == 49)
+        st.bg = ANSI_DEFAULT;
+      else if (v >= 90 && v <= 97)
+        st.fg = v - 90 + 8;
+      else if (v >= 100 && v <= 107)
+        st.bg = v - 100 + 8;
+    }
 
-      if (string->str[0] == '\014')
-        {
-          GtkTextIter start, end;
+  if (st.fg != ansi_cur.fg || st.bg != ansi_cur.bg || st.attrs != ansi_cur.attrs)
+    {
+      ansi_flush (iter);
+      ansi_cur = st;
+    }
+}
 
-          /* clear text if ^L received */
-          gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (text_buffer), &start);
-          gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
-          gtk_text_buffer_delete (GTK_TEXT_BUFFER (text_buffer), &start, &end);
-        }
-      else if (string->len > 0)
-        {
-          GtkTextIter end;
+/* insert text with ansi escape sequences. sgr sequences are rendered with tags, others are dropped.
+   state of parser is kept between calls, so sequences may be split between chunks of data */
+static void
+insert_ansi (GtkTextIter *iter, const gchar *buf, gsize len)
+{
+  const gchar *p = buf, *e = buf + len;
 
-          gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
+  while (p < e)
+    {
+      gchar c;
+
+      if (ansi_mode == ANSI_TEXT)
+        {
+          const gchar *esc = memchr (p, '\033', e - p);
+
+          g_string_append_len (ansi_run, p, (esc ? esc : e) - p);
+          if (esc == NULL)
+            break;
+          ansi_mode = ANSI_ESC;
+          p = esc + 1;
+          continue;
+        }
 
-          if (!g_utf8_validate (string->str, string->len, NULL))
+      c = *p++;
+      switch (ansi_mode)
+        {
+        case ANSI_ESC:
+          if (c == '[')
             {
-              gchar *utftext =
-                g_convert_with_fallback (string->str, string->len, "UTF-8", "ISO-8859-1", NULL, NULL, NULL, NULL);
-              if (options.text_data.formatted && !options.common_data.editable)
-                gtk_text_buffer_insert_markup (GTK_TEXT_BUFFER (text_buffer), &end, utftext, -1);
-              else
-                gtk_text_buffer_insert (GTK_TEXT_BUFFER (text_buffer), &end, utftext, -1);
-              g_free (utftext);
+              ansi_mode = ANSI_CSI;
+              ansi_n_params = 0;
+              ansi_params[0] = 0;
+              ansi_skip = FALSE;
             }
+          else if (c == ']' || c == 'P' || c == 'X' || c == '^' || c == '_')
+            /* string sequences (osc, dcs, sos, pm, apc) are skipped until terminator */
+            ansi_mode = ANSI_OSC;
+          else if (c >= 0x20 && c <= 0x2F)
+            /* like charset selection "ESC ( B" */
+            ansi_mode = ANSI_ESC_INTER;
           else
+            ansi_mode = ANSI_TEXT;
+          break;
+        case ANSI_ESC_INTER:
+          /* skip intermediate characters and the final one */
+          if (c < 0x20 || c > 0x2F)
+            ansi_mode = ANSI_TEXT;
+          break;
+        case ANSI_CSI:
+          if (c >= '0' && c <= '9')
             {
-              if (options.text_data.formatted && !options.common_data.editable)
-                gtk_text_buffer_insert_markup (GTK_TEXT_BUFFER (text_buffer), &end, string->str, string->len);
-              else
-                gtk_text_buffer_insert (GTK_TEXT_BUFFER (text_buffer), &end, string->str, string->len);
+              if (ansi_params[ansi_n_params] < 100000)
+                ansi_params[ansi_n_params] = ansi_params[ansi_n_params] * 10 + c - '0';
             }
-
-          if (options.common_data.tail)
+          else if (c == ';' || c == ':')
             {
-              while (gtk_events_pending ())
-                gtk_main_iteration ();
-              gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
-              gtk_text_view_scroll_to_iter (GTK_TEXT_VIEW (text_view), &end, 0, FALSE, 0, 0);
+              if (ansi_n_params < ANSI_MAX_PARAMS - 1)
+                ansi_n_params++;
+              ansi_params[ansi_n_params] = 0;
             }
-        }
-
-#ifdef HAVE_SOURCEVIEW
-      if (options.source_data.lang)
-        lang = gtk_source_language_manager_get_language (gtk_source_language_manager_get_default (), options.source_data.lang);
-      else
-        {
-          gchar *ctype;
-          if (options.common_data.mime && *options.common_data.mime)
-            ctype = g_content_type_from_mime_type (options.common_data.mime);
+          else if ((c >= 0x20 && c <= 0x2F) || (c >= 0x3C && c <= 0x3F))
+            /* private and intermediate characters mean this is not sgr */
+            ansi_skip = TRUE;
           else
-            ctype = g_content_type_guess (NULL, (const guchar *) string->str, string->len, NULL);
-          lang = gtk_source_language_manager_guess_language (gtk_source_language_manager_get_default (), options.common_data.uri, ctype);
-          g_free (ctype);
+            {
+              if (c == 'm' && !ansi_skip)
+                ansi_sgr (iter);
+              ansi_mode = ANSI_TEXT;
+            }
+          break;
+        case ANSI_OSC:
+          /* operating system commands (like titles or hyperlinks) end with BEL or ST */
+          if (c == '\007')
+            ansi_mode = ANSI_TEXT;
+          else if (c == '\033')
+            ansi_mode = ANSI_OSC_ESC;
+          break;
+        case ANSI_OSC_ESC:
+          ansi_mode = (c == '\\') ? ANSI_TEXT : ANSI_OSC;
+          break;
         }
-      gtk_source_buffer_set_language (GTK_SOURCE_BUFFER (text_buffer), lang);
-#endif
-
-      g_string_free (string, TRUE);
     }
 
-  return TRUE;
+  ansi_flush (iter);
 }
 
+/* data loading. data must be already decoded to valid utf-8 */
 static void
-fill_buffer_from_file ()
+insert_text (GtkTextIter *iter, const gchar *buf, gsize len)
 {
-  GtkTextIter iter;
-#ifdef HAVE_SOURCEVIEW
-  GtkSourceLanguage *lang;
-#endif
-  gchar *buf;
-  gsize len;
-  GError *err = NULL;
-
-  if (options.common_data.uri == NULL)
-    return;
-
-  if (!g_file_get_contents (options.common_data.uri, &buf, &len, &err))
+  if (options.text_data.ansi)
+    insert_ansi (iter, buf, len);
+  else if (options.text_data.formatted && !options.common_data.editable)
     {
-      g_printerr (_("Cannot open file '%s': %s\n"), options.common_data.uri, err->message);
-      return;
-    }
-
-  if (len <= 0)
-    return;
+      /* batch is inserted at once only if it is valid. otherwise lines are inserted
+         one by one, so a malformed line loses only itself */
+      if (pango_parse_markup (buf, len, 0, NULL, NULL, NULL, NULL))
+        gtk_text_buffer_insert_markup (GTK_TEXT_BUFFER (text_buffer), iter, buf, len);
+      else
+        {
+          const gchar *p = buf, *e = buf + len;
 
-  gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), &iter, 0);
+          while (p < e)
+            {
+              const gchar *nl = memchr (p, '\n', e - p);
+              const gchar *next = nl ? nl + 1 : e;
 
-  if (!g_utf8_validate (buf, -1, NULL))
-    {
-      gchar *utftext =
-        g_convert_with_fallback (buf, -1, "UTF-8", "ISO-8859-1", NULL, NULL, NULL, NULL);
-      if (options.text_data.formatted && !options.common_data.editable)
-        gtk_text_buffer_insert_markup (GTK_TEXT_BUFFER (text_buffer), &iter, utftext, -1);
-      else
-        gtk_text_buffer_insert (GTK_TEXT_BUFFER (text_buffer), &iter, utftext, -1);
-      g_free (utftext);
+              gtk_text_buffer_insert_markup (GTK_TEXT_BUFFER (text_buffer), iter, p, next - p);
+              p = next;
+            }
+        }
     }
   else
-    {
-      if (options.text_data.formatted && !options.common_data.editable)
-        gtk_text_buffer_insert_markup (GTK_TEXT_BUFFER (text_buffer), &iter, buf, -1);
-      else
-        gtk_text_buffer_insert (GTK_TEXT_BUFFER (text_buffer), &iter, buf, -1);
-    }
-  g_free (buf);
+    gtk_text_buffer_insert (GTK_TEXT_BUFFER (text_buffer), iter, buf, len);
+}
 
 #ifdef HAVE_SOURCEVIEW
+/* set highlighting language. returns FALSE if content type of data can't be guessed for sure */
+static gboolean
+set_language (const gchar *data, gsize len)
+{
+  GtkSourceLanguageManager *mgr = gtk_source_language_manager_get_default ();
+  GtkSourceLanguage *lang;
+  gboolean uncertain = FALSE;
+
   if (options.source_data.lang)
-    lang = gtk_source_language_manager_get_language (gtk_source_language_manager_get_default (), options.source_data.lang);
+    lang = gtk_source_language_manager_get_language (mgr, options.source_data.lang);
   else
     {
-      gchar *ctype = NULL;
+      gchar *ctype;
 
       if (options.common_data.mime && *options.common_data.mime)
         ctype = g_content_type_from_mime_type (options.common_data.mime);
       else
-        ctype = g_content_type_guess (options.common_data.uri, NULL, 0, NULL);
-      lang = gtk_source_language_manager_guess_language (gtk_source_language_manager_get_default (), options.common_data.uri, ctype);
+        ctype = g_content_type_guess (options.common_data.uri, (const guchar *) data, len, &uncertain);
+      lang = gtk_source_language_manager_guess_language (mgr, options.common_data.uri, ctype);
       g_free (ctype);
     }
-  gtk_source_buffer_set_language (GTK_SOURCE_BUFFER (text_buffer), lang);
-#endif
-}
 
-static void
-fill_buffer_from_stdin ()
-{
-  GIOChannel *channel;
+  /* changing of language rehighlights the whole buffer */
+  if (lang != gtk_source_buffer_get_language (GTK_SOURCE_BUFFER (text_buffer)))
+    gtk_source_buffer_set_language (GTK_SOURCE_BUFFER (text_buffer), lang);
 
-  channel = g_io_channel_unix_new (0);
-  g_io_channel_set_encoding (channel, NULL, NULL);
-  g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
-  g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, NULL);
+  return (lang != NULL || !uncertain);
 }
+#endif
 
+/* remove the oldest lines if text exceeds the limit. lines are removed in batches,
+   so this is done not at each insertion */
 static void
-text_changed_cb (GtkTextBuffer *b, gpointer d)
+trim_text ()
 {
-  text_changed = TRUE;
+  GtkTextBuffer *buf = GTK_TEXT_BUFFER (text_buffer);
+  GtkTextIter start, end;
+  gint lines, batch;
+
+  batch = MAX (options.text_data.max_lines / 10, 1);
+  lines = gtk_text_buffer_get_line_count (buf);
+  if (lines <= options.text_data.max_lines + batch)
+    return;
+
+  gtk_text_buffer_get_start_iter (buf, &start);
+  gtk_text_buffer_get_iter_at_line (buf, &end, lines - options.text_data.max_lines);
+
+#ifdef HAVE_SOURCEVIEW
+  /* marks of removed lines would be moved to the first line, so remove them too */
+  gtk_source_buffer_remove_source_marks (GTK_SOURCE_BUFFER (text_buffer), &start, &end, NULL);
+#endif
+  gtk_text_buffer_delete (buf, &start, &end);
+
+  /* saved search positions became invalid */
+  gtk_text_buffer_get_start_iter (buf, &match_start);
+  match_end = match_start;
+  if (search_bar)
+    search_bar->new_search = TRUE;
 }
 
-void
-text_goto_line ()
+/* pager mode. file is mapped to memory and only a window of its lines is kept in the buffer */
+static gpointer
+pager_index_thread (YadPagerIndex *pg)
 {
-  if (options.common_data.uri)
+  GArray *blk = g_array_new (FALSE, FALSE, sizeof (gsize));
+  gsize pos = 0;
+
+  while (pos < pg->len && !g_atomic_int_get (&pg->cancel))
     {
-      GtkTextIter iter;
+      gsize end = MIN (pos + PAGER_BLOCK, pg->len);
+      const gchar *p = pg->data + pos;
 
+      while ((p = memchr (p, '\n', pg->data + end - p)) != NULL)
+        {
+          gsize off = ++p - pg->data;
+          g_array_append_val (blk, off);
+        }
+      pos = end;
+
+      /* unterminated last line */
+      if (pos == pg->len && (pg->len == 0 || pg->data[pg->len - 1] != '\n'))
+        g_array_append_val (blk, pos);
+
+      g_mutex_lock (&pg->lock);
+      if (pg->n_offs + blk->len > pg->size)
+        {
+          while (pg->n_offs + blk->len > pg->size)
+            pg->size *= 2;
+          pg->offs = g_renew (gsize, pg->offs, pg->size);
+        }
+      memcpy (pg->offs + pg->n_offs, blk->data, blk->len * sizeof (gsize));
+      pg->n_offs += blk->len;
+      g_mutex_unlock (&pg->lock);
+
+      g_array_set_size (blk, 0);
+    }
+
+  g_array_free (blk, TRUE);
+
+  g_mutex_lock (&pg->lock);
+  pg->done = TRUE;
+  g_mutex_unlock (&pg->lock);
+
+  return NULL;
+}
+
+/* number of indexed lines */
+static guint
+pager_lines ()
+{
+  guint n;
+
+  g_mutex_lock (&pager->lock);
+  n = pager->n_offs - 1;
+  g_mutex_unlock (&pager->lock);
+
+  return n;
+}
+
+static gsize
+pager_offset (guint line)
+{
+  gsize off;
+
+  g_mutex_lock (&pager->lock);
+  off = pager->offs[line];
+  g_mutex_unlock (&pager->lock);
+
+  return off;
+}
+
+/* find the line with byte offset. returns -1 if this part of file is not indexed yet */
+static gint64
+pager_line_at (gsize off)
+{
+  guint lo = 0, hi;
+  gint64 res = -1;
+
+  g_mutex_lock (&pager->lock);
+  hi = pager->n_offs - 1;
+  if (hi > 0 && off < pager->offs[hi])
+    {
+      while (lo + 1 < hi)
+        {
+          guint mid = (lo + hi) / 2;
+          if (pager->offs[mid] <= off)
+            lo = mid;
+          else
+            hi = mid;
+        }
+      res = lo;
+    }
+  g_mutex_unlock (&pager->lock);
+
+  return res;
+}
+
+static void
+pager_close ()
+{
+  if (pager == NULL)
+    return;
+
+  if (pg_timer)
+    {
+      g_source_remove (pg_timer);
+      pg_timer = 0;
+    }
+
+  g_atomic_int_set (&pager->cancel, 1);
+  g_thread_join (pager->thread);
+  g_mutex_clear (&pager->lock);
+  g_mapped_file_unref (pager->map);
+  g_free (pager->offs);
+  yad_decoder_free (pager->dec);
+  g_free (pager);
+  pager = NULL;
+}
+
+static void
+pager_insert (GtkTextIter *iter, gsize start, gsize len)
+{
+  const gchar *out;
+  gsize out_len;
+
+  out = yad_decoder_feed (pager->dec, pager->data + start, len, TRUE, &out_len);
+  insert_text (iter, out, out_len);
+}
+
+/* put lines from first to the end of window to the buffer */
+static void
+pager_fill (guint first)
+{
+  guint n = pager_lines ();
+  GtkTextIter iter;
+
+  if (first + PAGER_LINES > n)
+    first = n > PAGER_LINES ? n - PAGER_LINES : 0;
+
+  /* attributes of previous window are not valid for the new one */
+  if (options.text_data.ansi)
+    ansi_reset ();
+
+  pg_busy = TRUE;
+
+  pg_start = first;
+  pg_count = MIN (PAGER_LINES, n - first);
+
+  gtk_text_buffer_set_text (GTK_TEXT_BUFFER (text_buffer), "", -1);
+  if (pg_count > 0)
+    {
+      gsize start = pager_offset (pg_start);
+
+      gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (text_buffer), &iter);
+      pager_insert (&iter, start, pager_offset (pg_start + pg_count) - start);
+    }
+
+  pg_busy = FALSE;
+}
+
+/* scroll to line and select len bytes from index in it */
+static void
+pager_show (guint line, gint index, gint len)
+{
+  GtkTextIter start, end;
+  gint bytes;
+
+  if (line < pg_start || line >= pg_start + pg_count)
+    pager_fill (line > PAGER_LINES / 2 ? line - PAGER_LINES / 2 : 0);
+  if (line < pg_start || line >= pg_start + pg_count)
+    return;
+
+  /* index may be wrong if the line was converted to utf-8 */
+  gtk_text_buffer_get_iter_at_line (GTK_TEXT_BUFFER (text_buffer), &start, line - pg_start);
+  bytes = gtk_text_iter_get_bytes_in_line (&start);
+  end = start;
+  gtk_text_iter_set_line_index (&start, MIN (index, bytes));
+  gtk_text_iter_set_line_index (&end, MIN (index + len, bytes));
+
+  gtk_text_buffer_select_range (GTK_TEXT_BUFFER (text_buffer), &start, &end);
+  gtk_text_buffer_move_mark (GTK_TEXT_BUFFER (text_buffer), pg_mark, &start);
+  gtk_text_view_scroll_to_mark (GTK_TEXT_VIEW (text_view), pg_mark, 0, TRUE, 0, 0.5);
+}
+
+static void
+pager_show_offset (gsize off, gint len)
+{
+  gint64 line = pager_line_at (off);
+
+  if (line == -1)
+    {
+      /* show it when this part of file will be indexed */
+      pg_goto_off = off;
+      pg_goto_len = len;
+      return;
+    }
+  pg_goto_off = -1;
+  pager_show (line, off - pager_offset (line), len);
+}
+
+static void
+pager_goto_line (guint line)
+{
+  if (line >= pager_lines ())
+    {
+      gboolean done;
+
+      g_mutex_lock (&pager->lock);
+      done = pager->done;
+      g_mutex_unlock (&pager->lock);
+
+      if (!done)
+        {
+          pg_goto_line = line;
+          return;
+        }
+      line = pager_lines () > 0 ? pager_lines () - 1 : 0;
+    }
+  pg_goto_line = -1;
+  pager_show (line, 0, 0);
+}
+
+/* move window when view is scrolled near its edges */
+static void
+pager_scroll_cb (GtkAdjustment *adj, gpointer d)
+{
+  gdouble val = gtk_adjustment_get_value (adj);
+  gdouble page = gtk_adjustment_get_page_size (adj);
+  gdouble upper = gtk_adjustment_get_upper (adj);
+  GtkTextIter iter;
+  guint first, top;
+
+  if (pg_busy || pager == NULL)
+    return;
+
+  if (val < page && pg_start > 0)
+    first = pg_start > PAGER_STEP ? pg_start - PAGER_STEP : 0;
+  else if (val + 2 * page > upper && pg_start + pg_count < pager_lines ())
+    first = pg_start + PAGER_STEP;
+  else
+    return;
+
+  /* keep the top visible line on its place */
+  gtk_text_view_get_line_at_y (GTK_TEXT_VIEW (text_view), &iter, (gint) val, NULL);
+  top = pg_start + gtk_text_iter_get_line (&iter);
+
+  pager_fill (first);
+
+  top = CLAMP (top, pg_start, pg_start + pg_count) - pg_start;
+  gtk_text_buffer_get_iter_at_line (GTK_TEXT_BUFFER (text_buffer), &iter, top);
+  gtk_text_buffer_move_mark (GTK_TEXT_BUFFER (text_buffer), pg_mark, &iter);
+  gtk_text_view_scroll_to_mark (GTK_TEXT_VIEW (text_view), pg_mark, 0, TRUE, 0, 0);
+}
+
+/* watch the indexing. fill the window while it's not full and do delayed jumps */
+static gboolean
+pager_check_cb (gpointer data)
+{
+  guint n = pager_lines ();
+  gboolean done;
+
+  g_mutex_lock (&pager->lock);
+  done = pager->done;
+  g_mutex_unlock (&pager->lock);
+
+  if (pg_count < PAGER_LINES && pg_start + pg_count < n)
+    {
+      GtkTextIter end;
+      guint last = MIN (pg_start + PAGER_LINES, n);
+      gsize start = pager_offset (pg_start + pg_count);
+
+      pg_busy = TRUE;
+      gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
+      pager_insert (&end, start, pager_offset (last) - start);
+      pg_count = last - pg_start;
+      pg_busy = FALSE;
+    }
+
+  if (pg_goto_line != -1 && (pg_goto_line < n || done))
+    pager_goto_line (pg_goto_line);
+  if (pg_goto_off != -1)
+    pager_show_offset (pg_goto_off, pg_goto_len);
+
+  if (done)
+    {
+      pg_timer = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+/* returns FALSE if file can't be shown by pages and must be loaded as a whole */
+static gboolean
+pager_open ()
+{
+  GMappedFile *map;
+  YadDecoder *dec;
+  GtkTextIter iter;
+  GError *err = NULL;
+  gsize len;
+
+  pager_close ();
+  pg_start = pg_count = 0;
+  /* matches of previous file are not valid */
+  scan_dirty = (hits && hits->len > 0);
+  pg_goto_off = -1;
+  pg_goto_line = -1;
+
+  map = g_mapped_file_new (options.common_data.uri, FALSE, &err);
+  if (map == NULL)
+    {
+      g_printerr (_("Cannot open file '%s': %s\n"), options.common_data.uri, err->message);
+      g_error_free (err);
+      return TRUE;
+    }
+
+  /* lines are indexed by newline bytes and pages are decoded separately,
+     so this works only for charsets where newline is a single byte */
+  dec = yad_decoder_new (options.common_data.encoding, FALSE);
+  len = g_mapped_file_get_length (map);
+  yad_decoder_feed (dec, g_mapped_file_get_contents (map), MIN (len, PAGER_DETECT_SIZE),
+                    len <= PAGER_DETECT_SIZE, &len);
+  if (!yad_decoder_ascii_compatible (dec))
+    {
+      if (options.debug)
+        g_printerr (_("WARNING: --pager doesn't work with UTF-16 and UTF-32 files\n"));
+      yad_decoder_free (dec);
+      g_mapped_file_unref (map);
+      return FALSE;
+    }
+  yad_decoder_free (dec);
+
+  pager = g_new0 (YadPagerIndex, 1);
+  pager->map = map;
+  pager->data = g_mapped_file_get_contents (map);
+  pager->len = g_mapped_file_get_length (map);
+  pager->size = 1024;
+  pager->offs = g_new (gsize, pager->size);
+  pager->offs[0] = 0;
+  pager->n_offs = 1;
+  pager->dec = yad_decoder_new (options.common_data.encoding, FALSE);
+  g_mutex_init (&pager->lock);
+
+  if (pg_mark == NULL)
+    {
+      gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (text_buffer), &iter);
+      pg_mark = gtk_text_buffer_create_mark (GTK_TEXT_BUFFER (text_buffer), NULL, &iter, TRUE);
+    }
+
+  pager->thread = g_thread_new ("pager", (GThreadFunc) pager_index_thread, pager);
+
+  gtk_text_buffer_set_text (GTK_TEXT_BUFFER (text_buffer), "", -1);
+  pg_timer = g_timeout_add (100, pager_check_cb, NULL);
+
+  return TRUE;
+}
+
+/* searching. worker thread scans a snapshot of text and matches are passed
+   to the main thread by portions */
+static gint64
+iter_key (GtkTextIter *it)
+{
+  if (pager == NULL)
+    return gtk_text_iter_get_offset (it);
+  if (pg_count == 0)
+    return 0;
+  return pager_offset (pg_start + gtk_text_iter_get_line (it)) + gtk_text_iter_get_line_index (it);
+}
+
+static gint64
+cursor_key ()
+{
+  GtkTextIter it;
+
+  gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (text_buffer), &it,
+                                    gtk_text_buffer_get_insert (GTK_TEXT_BUFFER (text_buffer)));
+  return iter_key (&it);
+}
+
+/* position of match is in characters for buffer and in bytes for pager */
+static inline gint64
+hit_key (guint i)
+{
+  YadTextHit *h = &g_array_index (hits, YadTextHit, i);
+  return pager ? (gint64) h->off : h->pos;
+}
+
+/* index of the first match at or after key */
+static guint
+find_hit (gint64 key)
+{
+  guint lo = 0, hi = hits->len;
+
+  while (lo < hi)
+    {
+      guint mid = (lo + hi) / 2;
+      if (hit_key (mid) < key)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static gboolean
+hit_iters (YadTextHit *h, GtkTextIter *start, GtkTextIter *end)
+{
+  if (pager)
+    {
+      gint64 line = pager_line_at (h->off);
+      gint bytes, index;
+
+      if (line < pg_start || line >= pg_start + pg_count)
+        return FALSE;
+
+      gtk_text_buffer_get_iter_at_line (GTK_TEXT_BUFFER (text_buffer), start, line - pg_start);
+      bytes = gtk_text_iter_get_bytes_in_line (start);
+      index = h->off - pager_offset (line);
+      *end = *start;
+      gtk_text_iter_set_line_index (start, MIN (index, bytes));
+      gtk_text_iter_set_line_index (end, MIN (index + h->len, bytes));
+    }
+  else
+    {
+      gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), start, h->pos);
+      gtk_text_buffer_get_iter_at_offset (GTK_TEXT_BUFFER (text_buffer), end, h->pos + h->chars);
+    }
+
+  return TRUE;
+}
+
+/* only visible matches are highlighted */
+static void
+highlight_hits ()
+{
+  GtkTextBuffer *buf = GTK_TEXT_BUFFER (text_buffer);
+  GdkRectangle rect;
+  GtkTextIter start, end;
+  gint64 to;
+  guint i;
+
+  if (hit_tag == NULL)
+    return;
+
+  if (hl_start)
+    {
+      gtk_text_buffer_get_iter_at_mark (buf, &start, hl_start);
+      gtk_text_buffer_get_iter_at_mark (buf, &end, hl_end);
+      gtk_text_buffer_remove_tag (buf, hit_tag, &start, &end);
+    }
+
+  if (hits == NULL || hits->len == 0 || scan_dirty)
+    return;
+
+  gtk_text_view_get_visible_rect (GTK_TEXT_VIEW (text_view), &rect);
+  gtk_text_view_get_line_at_y (GTK_TEXT_VIEW (text_view), &start, rect.y, NULL);
+  gtk_text_view_get_line_at_y (GTK_TEXT_VIEW (text_view), &end, rect.y + rect.height, NULL);
+  if (!gtk_text_iter_ends_line (&end))
+    gtk_text_iter_forward_to_line_end (&end);
+
+  if (hl_start == NULL)
+    {
+      hl_start = gtk_text_buffer_create_mark (buf, NULL, &start, TRUE);
+      hl_end = gtk_text_buffer_create_mark (buf, NULL, &end, FALSE);
+    }
+  else
+    {
+      gtk_text_buffer_move_mark (buf, hl_start, &start);
+      gtk_text_buffer_move_mark (buf, hl_end, &end);
+    }
+
+  to = iter_key (&end);
+  for (i = find_hit (iter_key (&start)); i < hits->len && hit_key (i) <= to; i++)
+    {
+      GtkTextIter ms, me;
+
+      if (hit_iters (&g_array_index (hits, YadTextHit, i), &ms, &me))
+        gtk_text_buffer_apply_tag (buf, hit_tag, &ms, &me);
+    }
+}
+
+static void
+update_count ()
+{
+  gchar *str;
+
+  if (search_bar->count == NULL)
+    return;
+
+  if (search_bar->str == NULL || search_bar->str[0] == '\0' || hits == NULL)
+    {
+      gtk_label_set_text (GTK_LABEL (search_bar->count), "");
+      return;
+    }
+
+  if (scan_done)
+    str = g_strdup_printf (_("%d of %u"), cur_hit + 1, hits->len);
+  else
+    str = g_strdup_printf (_("%d of %u..."), cur_hit + 1, hits->len);
+  gtk_label_set_text (GTK_LABEL (search_bar->count), str);
+  g_free (str);
+}
+
+static void
+show_hit (guint i)
+{
+  YadTextHit *h = &g_array_index (hits, YadTextHit, i);
+
+  cur_hit = i;
+  if (pager)
+    pager_show_offset (h->off, h->len);
+  else
+    {
+      hit_iters (h, &match_start, &match_end);
+      gtk_text_view_scroll_to_iter (GTK_TEXT_VIEW (text_view), &match_start, 0.0, FALSE, 0.0, 0.0);
+      gtk_text_buffer_select_range (GTK_TEXT_BUFFER (text_buffer), &match_start, &match_end);
+    }
+  search_changed = TRUE;
+
+  update_count ();
+}
+
+static void
+text_scan_free (YadTextScan *scan)
+{
+  g_regex_unref (scan->re);
+  g_free (scan->text);
+  if (scan->map)
+    g_mapped_file_unref (scan->map);
+  g_array_free (scan->hits, TRUE);
+  g_mutex_clear (&scan->lock);
+  g_free (scan);
+}
+
+static void
+text_scan_thread (GTask *task, gpointer src, gpointer data, GCancellable *cancel)
+{
+  YadTextScan *scan = (YadTextScan *) data;
+  GArray *blk = g_array_new (FALSE, FALSE, sizeof (YadTextHit));
+  gsize start = 0, prev = 0;
+  glong pos = 0;
+
+  while (start < scan->len)
+    {
+      GMatchInfo *mi;
+      const gchar *nl;
+      gsize end = start + TEXT_SCAN_BLOCK;
+
+      if (g_cancellable_is_cancelled (cancel))
+        {
+          g_array_free (blk, TRUE);
+          g_task_return_boolean (task, FALSE);
+          return;
+        }
+
+      /* block is matched separately, so it must end at line boundary */
+      if (end < scan->len && (nl = memchr (scan->data + end, '\n', scan->len - end)) != NULL)
+        end = nl - scan->data + 1;
+      else
+        end = scan->len;
+
+      g_regex_match_full (scan->re, scan->data + start, end - start, 0, G_REGEX_MATCH_NOTEMPTY, &mi, NULL);
+      while (g_match_info_matches (mi))
+        {
+          YadTextHit h;
+          gint sp, ep;
+
+          g_match_info_fetch_pos (mi, 0, &sp, &ep);
+          h.off = start + sp;
+          h.len = ep - sp;
+          if (scan->map == NULL)
+            {
+              pos += g_utf8_strlen (scan->data + prev, h.off - prev);
+              h.pos = pos;
+              h.chars = g_utf8_strlen (scan->data + h.off, h.len);
+              pos += h.chars;
+              prev = h.off + h.len;
+            }
+          g_array_append_val (blk, h);
+
+          g_match_info_next (mi, NULL);
+        }
+      g_match_info_free (mi);
+
+      g_mutex_lock (&scan->lock);
+      g_array_append_vals (scan->hits, blk->data, blk->len);
+      g_mutex_unlock (&scan->lock);
+      g_array_set_size (blk, 0);
+
+      start = end;
+    }
+
+  g_array_free (blk, TRUE);
+  g_task_return_boolean (task, TRUE);
+}
+
+/* take found matches from the worker */
+static void
+text_scan_update ()
+{
+  YadTextScan *scan = (YadTextScan *) g_task_get_task_data (scan_task);
+  guint old = hits->len;
+
+  g_mutex_lock (&scan->lock);
+  g_array_append_vals (hits, scan->hits->data, scan->hits->len);
+  g_array_set_size (scan->hits, 0);
+  g_mutex_unlock (&scan->lock);
+
+  if (hits->len > old)
+    {
+      if (want_hit != -1)
+        {
+          guint i = find_hit (want_hit);
+          if (i < hits->len)
+            {
+              want_hit = -1;
+              show_hit (i);
+            }
+        }
+      highlight_hits ();
+    }
+
+  update_count ();
+}
+
+static gboolean
+text_scan_timer_cb (gpointer data)
+{
+  text_scan_update ();
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+text_scan_done_cb (GObject *src, GAsyncResult *res, gpointer data)
+{
+  /* scan was cancelled by the next query */
+  if (!g_task_propagate_boolean (G_TASK (res), NULL) || G_TASK (res) != scan_task)
+    return;
+
+  g_source_remove (scan_timer);
+  scan_timer = 0;
+  scan_done = TRUE;
+
+  /* short texts are scanned at once, so all matches come with this update */
+  text_scan_update ();
+  /* wanted match is still not found, so there are no matches after cursor */
+  want_hit = -1;
+}
+
+static void
+text_scan_stop ()
+{
+  if (scan_task == NULL)
+    return;
+
+  g_cancellable_cancel (scan_cancel);
+  g_clear_object (&scan_cancel);
+  g_clear_object (&scan_task);
+  if (scan_timer)
+    {
+      g_source_remove (scan_timer);
+      scan_timer = 0;
+    }
+}
+
+static void
+text_scan_start ()
+{
+  YadTextScan *scan;
+  GRegexCompileFlags flags = G_REGEX_OPTIMIZE | G_REGEX_MULTILINE;
+  GRegex *re;
+  gchar *pat;
+
+  text_scan_stop ();
+
+  if (hits == NULL)
+    hits = g_array_new (FALSE, FALSE, sizeof (YadTextHit));
+  g_array_set_size (hits, 0);
+  cur_hit = -1;
+  scan_done = FALSE;
+  scan_dirty = FALSE;
+  highlight_hits ();
+
+  if (search_bar->str == NULL || search_bar->str[0] == '\0')
+    {
+      want_hit = -1;
+      update_count ();
+      return;
+    }
+
+  if (search_bar->regex)
+    pat = g_strdup (search_bar->str);
+  else
+    pat = g_regex_escape_string (search_bar->str, -1);
+  if (search_bar->whole_word)
+    {
+      gchar *tmp = g_strdup_printf ("\\b(?:%s)\\b", pat);
+      g_free (pat);
+      pat = tmp;
+    }
+
+  if (!search_bar->case_sensitive)
+    flags |= G_REGEX_CASELESS;
+  /* mapped file may be not in utf-8 */
+  if (pager)
+    flags |= G_REGEX_RAW;
+
+  re = g_regex_new (pat, flags, 0, NULL);
+  g_free (pat);
+  /* pattern is incomplete */
+  if (re == NULL)
+    {
+      update_count ();
+      return;
+    }
+
+  scan = g_new0 (YadTextScan, 1);
+  scan->re = re;
+  scan->hits = g_array_new (FALSE, FALSE, sizeof (YadTextHit));
+  g_mutex_init (&scan->lock);
+
+  if (pager)
+    {
+      scan->map = g_mapped_file_ref (pager->map);
+      scan->data = pager->data;
+      scan->len = pager->len;
+    }
+  else
+    {
+      GtkTextIter start, end;
+
+      /* slice keeps character offsets the same as in buffer */
+      gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (text_buffer), &start, &end);
+      scan->text = gtk_text_buffer_get_slice (GTK_TEXT_BUFFER (text_buffer), &start, &end, TRUE);
+      scan->data = scan->text;
+      scan->len = strlen (scan->text);
+    }
+
+  scan_cancel = g_cancellable_new ();
+  scan_task = g_task_new (NULL, scan_cancel, text_scan_done_cb, NULL);
+  g_task_set_task_data (scan_task, scan, (GDestroyNotify) text_scan_free);
+  g_task_run_in_thread (scan_task, text_scan_thread);
+
+  scan_timer = g_timeout_add (100, text_scan_timer_cb, NULL);
+}
+
+static void
+do_find_next (GtkWidget *w, gpointer d)
+{
+  guint i;
+
+  /* text was changed after scanning */
+  if (scan_dirty)
+    {
+      text_scan_start ();
+      want_hit = cursor_key ();
+      return;
+    }
+
+  if (hits == NULL || search_bar->str == NULL)
+    return;
+
+  if (cur_hit != -1)
+    i = cur_hit + 1;
+  else
+    i = find_hit (cursor_key ());
+
+  if (i < hits->len)
+    show_hit (i);
+  else if (!scan_done)
+    want_hit = hits->len ? hit_key (hits->len - 1) + 1 : cursor_key ();
+}
+
+static void
+do_find_prev (GtkWidget *w, gpointer d)
+{
+  gint i;
+
+  if (scan_dirty)
+    {
+      text_scan_start ();
+      return;
+    }
+
+  if (hits == NULL || search_bar->str == NULL)
+    return;
+
+  if (cur_hit != -1)
+    i = cur_hit - 1;
+  else
+    i = (gint) find_hit (cursor_key ()) - 1;
+
+  if (i >= 0)
+    show_hit (i);
+}
+
+static void
+search_changed_cb (GtkWidget *w, gpointer d)
+{
+  search_bar->new_search = TRUE;
+  search_bar->str = gtk_entry_get_text (GTK_ENTRY (search_bar->entry));
+
+  /* select the first match after cursor when it will be found */
+  want_hit = cursor_key ();
+  text_scan_start ();
+}
+
+static void
+search_text_changed_cb (GtkTextBuffer *b, gpointer d)
+{
+  /* in pager mode buffer is changed by moving the window only */
+  if (pager == NULL && hits && hits->len > 0)
+    scan_dirty = TRUE;
+}
+
+static void
+search_scroll_cb (GtkAdjustment *adj, gpointer d)
+{
+  if (hits && hits->len > 0)
+    highlight_hits ();
+}
+
+static void
+stop_search_cb (GtkWidget *w, YadSearchBar *sb)
+{
+  ignore_esc = FALSE;
+  gtk_search_bar_set_search_mode (GTK_SEARCH_BAR (search_bar->bar), FALSE);
+  gtk_widget_grab_focus (text_view);
+  if (search_changed && !pager)
+    {
+      gtk_text_iter_backward_char (&match_start);
+      gtk_text_buffer_place_cursor (GTK_TEXT_BUFFER (text_buffer), &match_start);
+    }
+  search_changed = FALSE;
+}
+
+static gboolean
+flush_text (gpointer data)
+{
+  gchar *str = pending_text->str;
+  gsize len = pending_text->len;
+
+  /* only complete lines are inserted, the rest waits for more data */
+  if (!stdin_eof)
+    {
+      while (len > 0 && str[len - 1] != '\n')
+        len--;
+    }
+
+  if (len > 0)
+    {
+      GtkTextIter end;
+      gchar *start = str, *p = str;
+
+      /* ^L at the beginning of line clears the text. all data before it may be dropped */
+      while (p < str + len)
+        {
+          gchar *nl = memchr (p, '\n', str + len - p);
+          gchar *next = nl ? nl + 1 : str + len;
+
+          if (*p == '\014')
+            {
+              GtkTextIter st;
+
+              gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (text_buffer), &st, &end);
+              gtk_text_buffer_delete (GTK_TEXT_BUFFER (text_buffer), &st, &end);
+              start = next;
+            }
+          p = next;
+        }
+
+      if (start < str + len)
+        {
+          gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
+          insert_text (&end, start, str + len - start);
+
+#ifdef HAVE_SOURCEVIEW
+          /* guess language by the first part of data until the result is sure */
+          if (guess_data)
+            {
+              g_string_append_len (guess_data, start, MIN (str + len - start, TEXT_GUESS_MAX));
+              if (set_language (guess_data->str, guess_data->len) || guess_data->len >= TEXT_GUESS_MAX)
+                {
+                  g_string_free (guess_data, TRUE);
+                  guess_data = NULL;
+                }
+            }
+#endif
+        }
+
+      g_string_erase (pending_text, 0, len);
+
+      if (options.text_data.max_lines > 0)
+        trim_text ();
+
+      if (options.common_data.tail)
+        gtk_text_view_scroll_to_mark (GTK_TEXT_VIEW (text_view), end_mark, 0, FALSE, 0, 0);
+    }
+
+  flush_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+handle_stdin (GIOChannel * channel, GIOCondition condition, gpointer data)
+{
+  gint fd = g_io_channel_unix_get_fd (channel);
+  gchar buf[TEXT_READ_CHUNK];
+  const gchar *out;
+  gsize total = 0, out_len;
+  gboolean eof = FALSE;
+
+  /* read all available data, but not too much for keeping ui responsive */
+  while (total < TEXT_READ_MAX)
+    {
+      gssize n;
+
+      do
+        n = read (fd, buf, TEXT_READ_CHUNK);
+      while (n < 0 && errno == EINTR);
+
+      if (n < 0)
+        {
+          if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+              g_printerr ("yad_text_handle_stdin(): %s\n", g_strerror (errno));
+              eof = TRUE;
+            }
+          break;
+        }
+      else if (n == 0)
+        {
+          eof = TRUE;
+          break;
+        }
+      total += n;
+
+      out = yad_decoder_feed (stdin_dec, buf, n, FALSE, &out_len);
+      g_string_append_len (pending_text, out, out_len);
+    }
+
+  if (eof)
+    {
+      out = yad_decoder_feed (stdin_dec, NULL, 0, TRUE, &out_len);
+      g_string_append_len (pending_text, out, out_len);
+      yad_decoder_free (stdin_dec);
+      stdin_dec = NULL;
+
+      /* insert the rest of data immediately */
+      stdin_eof = TRUE;
+      if (flush_id)
+        g_source_remove (flush_id);
+      flush_text (NULL);
+      g_io_channel_shutdown (channel, FALSE, NULL);
+      return FALSE;
+    }
+
+  /* data is inserted at most once per frame */
+  if (flush_id == 0 && pending_text->len > 0)
+    flush_id = g_timeout_add (TEXT_FLUSH_DELAY, flush_text, NULL);
+
+  return TRUE;
+}
+
+/* file operations. files are read and written by chunks in main loop,
+   so slow file systems don't block the dialog */
+static void
+file_op_progress ()
+{
+  if (file_op->size > 0)
+    gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (op_bar), MIN ((gdouble) file_op->done / file_op->size, 1.0));
+  else
+    gtk_progress_bar_pulse (GTK_PROGRESS_BAR (op_bar));
+}
+
+static void
+file_op_finish (GError *err)
+{
+  YadFileOp *op = file_op;
+
+  if (err)
+    {
+      if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          if (op->saving)
+            g_printerr (_("Cannot save file %s: %s\n"), options.common_data.uri, err->message);
+          else
+            g_printerr (_("Cannot open file '%s': %s\n"), options.common_data.uri, err->message);
+        }
+    }
+
+  /* nothing is lost if file doesn't exist yet */
+  if (!op->saving)
+    load_incomplete = (err && !g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_FOUND));
+  g_clear_error (&err);
+
+  if (op->in)
+    g_object_unref (op->in);
+  if (op->out)
+    {
+      /* closing with cancelled operation keeps the original file */
+      g_cancellable_cancel (op->cancel);
+      g_output_stream_close (op->out, op->cancel, NULL);
+      g_object_unref (op->out);
+    }
+  g_object_unref (op->file);
+  g_object_unref (op->cancel);
+  if (op->dec)
+    yad_decoder_free (op->dec);
+  g_string_free (op->rest, TRUE);
+  g_free (op->data);
+  gtk_text_buffer_delete_mark (GTK_TEXT_BUFFER (text_buffer), op->pos);
+  g_free (op);
+  file_op = NULL;
+
+  gtk_widget_hide (op_box);
+  gtk_text_view_set_editable (GTK_TEXT_VIEW (text_view), options.common_data.editable);
+}
+
+static void
+file_op_cancel_cb (GtkWidget *w, gpointer d)
+{
+  if (file_op)
+    g_cancellable_cancel (file_op->cancel);
+}
+
+static YadFileOp *
+file_op_new (gboolean saving)
+{
+  GtkTextIter iter;
+
+  file_op = g_new0 (YadFileOp, 1);
+  file_op->saving = saving;
+  file_op->file = g_file_new_for_commandline_arg (options.common_data.uri);
+  file_op->cancel = g_cancellable_new ();
+  file_op->rest = g_string_new (NULL);
+  if (!saving)
+    file_op->dec = yad_decoder_new (options.common_data.encoding, FALSE);
+
+  gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (text_buffer), &iter);
+  file_op->pos = gtk_text_buffer_create_mark (GTK_TEXT_BUFFER (text_buffer), NULL, &iter, FALSE);
+
+  /* text must not be changed while it is loaded or saved */
+  gtk_text_view_set_editable (GTK_TEXT_VIEW (text_view), FALSE);
+
+  gtk_progress_bar_set_text (GTK_PROGRESS_BAR (op_bar), options.common_data.uri);
+  gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (op_bar), 0.0);
+  gtk_widget_show (op_box);
+
+  return file_op;
+}
+
+/* insert read data. formatted text is inserted at once at the end */
+static void
+read_insert (const gchar *buf, gsize len, gboolean eof)
+{
+  YadFileOp *op = file_op;
+  GtkTextIter iter;
+  const gchar *out;
+  gsize out_len;
+
+  out = yad_decoder_feed (op->dec, buf, len, eof, &out_len);
+  g_string_append_len (op->rest, out, out_len);
+
+  if (op->rest->len == 0 || (options.text_data.formatted && !options.common_data.editable && !eof))
+    return;
+
+  gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (text_buffer), &iter, op->pos);
+  insert_text (&iter, op->rest->str, op->rest->len);
+  g_string_truncate (op->rest, 0);
+}
+
+static void
+read_chunk_cb (GObject *src, GAsyncResult *res, gpointer d)
+{
+  GBytes *bytes;
+  GError *err = NULL;
+  gsize len;
+
+  bytes = g_input_stream_read_bytes_finish (G_INPUT_STREAM (src), res, &err);
+  if (bytes == NULL)
+    {
+      file_op_finish (err);
+      return;
+    }
+
+  len = g_bytes_get_size (bytes);
+  read_insert (g_bytes_get_data (bytes, NULL), len, len == 0);
+  g_bytes_unref (bytes);
+
+  if (len == 0)
+    {
+      file_op_finish (NULL);
+      text_changed = FALSE;
+      if (goto_pending)
+        text_goto_line ();
+      return;
+    }
+
+  file_op->done += len;
+  file_op_progress ();
+
+  g_input_stream_read_bytes_async (file_op->in, FILE_OP_CHUNK, G_PRIORITY_DEFAULT,
+                                   file_op->cancel, read_chunk_cb, NULL);
+}
+
+static void
+read_info_cb (GObject *src, GAsyncResult *res, gpointer d)
+{
+  GFileInfo *info;
+
+  /* size is needed only for progress, so errors are ignored */
+  info = g_file_input_stream_query_info_finish (G_FILE_INPUT_STREAM (src), res, NULL);
+  if (info)
+    {
+      file_op->size = g_file_info_get_size (info);
+      g_object_unref (info);
+    }
+
+  g_input_stream_read_bytes_async (file_op->in, FILE_OP_CHUNK, G_PRIORITY_DEFAULT,
+                                   file_op->cancel, read_chunk_cb, NULL);
+}
+
+static void
+read_open_cb (GObject *src, GAsyncResult *res, gpointer d)
+{
+  GError *err = NULL;
+
+  file_op->in = (GInputStream *) g_file_read_finish (G_FILE (src), res, &err);
+  if (file_op->in == NULL)
+    {
+      file_op_finish (err);
+      return;
+    }
+
+  g_file_input_stream_query_info_async (G_FILE_INPUT_STREAM (file_op->in), G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                        G_PRIORITY_DEFAULT, file_op->cancel, read_info_cb, NULL);
+}
+
+static void
+fill_buffer_from_file ()
+{
+  if (options.common_data.uri == NULL)
+    return;
+
+  if (options.text_data.pager && pager_open ())
+    {
+#ifdef HAVE_SOURCEVIEW
+      set_language (NULL, 0);
+#endif
+      return;
+    }
+
+  if (file_op)
+    return;
+
+#ifdef HAVE_SOURCEVIEW
+  set_language (NULL, 0);
+#endif
+
+  /* text is replaced, so previous changes can't be saved to the new file */
+  text_changed = FALSE;
+  file_op_new (FALSE);
+  g_file_read_async (file_op->file, G_PRIORITY_DEFAULT, file_op->cancel, read_open_cb, NULL);
+}
+
+/* get next slice of text for writing. returns NULL at the end of buffer */
+static gchar *
+next_slice (GtkTextMark *pos)
+{
+  GtkTextIter start, end;
+  gchar *text;
+
+  gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (text_buffer), &start, pos);
+  if (gtk_text_iter_is_end (&start))
+    return NULL;
+
+  end = start;
+  gtk_text_iter_forward_chars (&end, FILE_OP_CHUNK);
+  text = gtk_text_buffer_get_text (GTK_TEXT_BUFFER (text_buffer), &start, &end, FALSE);
+  gtk_text_buffer_move_mark (GTK_TEXT_BUFFER (text_buffer), pos, &end);
+
+  return text;
+}
+
+static void
+save_close_cb (GObject *src, GAsyncResult *res, gpointer d)
+{
+  GError *err = NULL;
+
+  if (g_output_stream_close_finish (G_OUTPUT_STREAM (src), res, &err))
+    {
+      g_clear_object (&file_op->out);
+      text_changed = FALSE;
+    }
+  file_op_finish (err);
+}
+
+static void save_write_cb (GObject *src, GAsyncResult *res, gpointer d);
+
+/* write next slice of text or close the file at the end */
+static void
+save_next ()
+{
+  g_free (file_op->data);
+  file_op->data = next_slice (file_op->pos);
+
+  if (file_op->data)
+    g_output_stream_write_all_async (file_op->out, file_op->data, strlen (file_op->data), G_PRIORITY_DEFAULT,
+                                     file_op->cancel, save_write_cb, NULL);
+  else
+    g_output_stream_close_async (file_op->out, G_PRIORITY_DEFAULT, file_op->cancel, save_close_cb, NULL);
+}
+
+static void
+save_write_cb (GObject *src, GAsyncResult *res, gpointer d)
+{
+  GError *err = NULL;
+
+  if (!g_output_stream_write_all_finish (G_OUTPUT_STREAM (src), res, NULL, &err))
+    {
+      file_op_finish (err);
+      return;
+    }
+
+  file_op->done += FILE_OP_CHUNK;
+  file_op_progress ();
+
+  save_next ();
+}
+
+static void
+save_open_cb (GObject *src, GAsyncResult *res, gpointer d)
+{
+  GError *err = NULL;
+
+  file_op->out = (GOutputStream *) g_file_replace_finish (G_FILE (src), res, &err);
+  if (file_op->out == NULL)
+    {
+      file_op_finish (err);
+      return;
+    }
+
+  save_next ();
+}
+
+/* save text to file. it is written to temporary file which replaces the original one after closing.
+   if wait is TRUE the text is saved synchronously */
+static void
+save_text (gboolean wait)
+{
+  if (options.common_data.uri == NULL)
+    return;
+
+  if (load_incomplete)
+    {
+      g_printerr (_("Cannot save file %s: file was not loaded completely\n"), options.common_data.uri);
+      return;
+    }
+
+  if (file_op)
+    {
+      /* partly loaded text must never replace the file */
+      if (!wait || !file_op->saving)
+        return;
+      /* restart saving synchronously before exit */
+      g_cancellable_cancel (file_op->cancel);
+      while (file_op)
+        gtk_main_iteration ();
+    }
+
+  file_op_new (TRUE);
+  file_op->size = gtk_text_buffer_get_char_count (GTK_TEXT_BUFFER (text_buffer));
+
+  if (wait)
+    {
+      GError *err = NULL;
+
+      file_op->out = (GOutputStream *) g_file_replace (file_op->file, NULL, FALSE, G_FILE_CREATE_NONE,
+                                                       file_op->cancel, &err);
+      if (file_op->out)
+        {
+          while ((file_op->data = next_slice (file_op->pos)) != NULL)
+            {
+              if (!g_output_stream_write_all (file_op->out, file_op->data, strlen (file_op->data),
+                                              NULL, file_op->cancel, &err))
+                break;
+              g_free (file_op->data);
+              file_op->data = NULL;
+            }
+          if (err == NULL && g_output_stream_close (file_op->out, file_op->cancel, &err))
+            {
+              g_clear_object (&file_op->out);
+              text_changed = FALSE;
+            }
+        }
+      file_op_finish (err);
+    }
+  else
+    g_file_replace_async (file_op->file, NULL, FALSE, G_FILE_CREATE_NONE, G_PRIORITY_DEFAULT,
+                          file_op->cancel, save_open_cb, NULL);
+}
+
+static void
+fill_buffer_from_stdin ()
+{
+  GIOChannel *channel;
+  GtkTextIter end;
+
+  pending_text = g_string_sized_new (TEXT_READ_CHUNK);
+  stdin_dec = yad_decoder_new (options.common_data.encoding, FALSE);
+#ifdef HAVE_SOURCEVIEW
+  guess_data = g_string_new (NULL);
+#endif
+
+  /* mark at the end of text for scrolling in tail mode */
+  gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (text_buffer), &end);
+  end_mark = gtk_text_buffer_create_mark (GTK_TEXT_BUFFER (text_buffer), NULL, &end, FALSE);
+
+  channel = g_io_channel_unix_new (0);
+  g_io_channel_set_encoding (channel, NULL, NULL);
+  g_io_channel_set_flags (channel, G_IO_FLAG_NONBLOCK, NULL);
+  g_io_add_watch (channel, G_IO_IN | G_IO_HUP, handle_stdin, NULL);
+}
+
+static void
+text_changed_cb (GtkTextBuffer *b, gpointer d)
+{
+  /* insertions of loaded data are not user's changes */
+  if (file_op && !file_op->saving)
+    return;
+  text_changed = TRUE;
+}
+
+void
+text_goto_line ()
+{
+  if (pager)
+    pager_goto_line (options.text_data.line);
+  else if (file_op && !file_op->saving)
+    {
+      /* jump after loading */
+      goto_pending = TRUE;
+    }
+  else if (options.common_data.uri)
+    {
+      GtkTextIter iter;
+
+      goto_pending = FALSE;
       while (gtk_events_pending ())
         gtk_main_iteration ();
 
@@ -656,6 +2364,26 @@ text_create_widget (GtkWidget * dlg)
   gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw), options.data.hscroll_policy, options.data.vscroll_policy);
   gtk_box_pack_start (GTK_BOX (w), sw, TRUE, TRUE, 0);
 
+  /* progress of file loading and saving */
+  op_box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 2);
+  gtk_widget_set_no_show_all (op_box, TRUE);
+  gtk_box_pack_start (GTK_BOX (w), op_box, FALSE, FALSE, 0);
+
+  op_bar = gtk_progress_bar_new ();
+  gtk_progress_bar_set_show_text (GTK_PROGRESS_BAR (op_bar), TRUE);
+  gtk_widget_set_valign (op_bar, GTK_ALIGN_CENTER);
+  gtk_box_pack_start (GTK_BOX (op_box), op_bar, TRUE, TRUE, 0);
+  gtk_widget_show (op_bar);
+
+  {
+    GtkWidget *b = gtk_button_new_from_icon_name ("process-stop", GTK_ICON_SIZE_BUTTON);
+    gtk_button_set_relief (GTK_BUTTON (b), GTK_RELIEF_NONE);
+    gtk_widget_set_tooltip_text (b, _("Cancel"));
+    g_signal_connect (G_OBJECT (b), "clicked", G_CALLBACK (file_op_cancel_cb), NULL);
+    gtk_box_pack_start (GTK_BOX (op_box), b, FALSE, FALSE, 0);
+    gtk_widget_show (b);
+  }
+
 #ifdef HAVE_SOURCEVIEW
   text_buffer = (GObject *) gtk_source_buffer_new (NULL);
   tv = text_view = gtk_source_view_new_with_buffer (GTK_SOURCE_BUFFER (text_buffer));
@@ -664,6 +2392,15 @@ text_create_widget (GtkWidget * dlg)
   tv = text_view = gtk_text_view_new_with_buffer (GTK_TEXT_BUFFER (text_buffer));
 #endif
   gtk_widget_set_name (text_view, "yad-text-widget");
+
+  /* pager works only for viewing of files */
+  if (options.text_data.pager && (options.common_data.editable || options.common_data.uri == NULL))
+    {
+      if (options.debug)
+        g_printerr (_("WARNING: --pager works only for non-editable files\n"));
+      options.text_data.pager = FALSE;
+    }
+
   gtk_text_view_set_justification (GTK_TEXT_VIEW (text_view), options.text_data.justify);
   gtk_text_view_set_left_margin (GTK_TEXT_VIEW (text_view), options.text_data.margins);
   gtk_text_view_set_right_margin (GTK_TEXT_VIEW (text_view), options.text_data.margins);
@@ -804,10 +2541,8 @@ text_create_widget (GtkWidget * dlg)
   /* Initialize linkifying */
   if (options.text_data.uri)
     {
-      GRegex *regex;
-
-      regex = g_regex_new (YAD_URL_REGEX,
-                           G_REGEX_CASELESS | G_REGEX_OPTIMIZE | G_REGEX_EXTENDED, G_REGEX_MATCH_NOTEMPTY, NULL);
+      link_re = g_regex_new (YAD_URL_REGEX,
+                             G_REGEX_CASELESS | G_REGEX_OPTIMIZE | G_REGEX_EXTENDED, G_REGEX_MATCH_NOTEMPTY, NULL);
 
       /* Create text tag for URI */
       tag = gtk_text_buffer_create_tag (GTK_TEXT_BUFFER (text_buffer), NULL,
@@ -822,21 +2557,36 @@ text_create_widget (GtkWidget * dlg)
       normal = gdk_cursor_new_for_display (gdk_display_get_default (), GDK_XTERM);
       g_signal_connect (G_OBJECT (text_view), "motion-notify-event", G_CALLBACK (motion_cb), NULL);
 
-      g_signal_connect_after (G_OBJECT (text_buffer), "changed", G_CALLBACK (linkify_cb), regex);
+      g_signal_connect_after (G_OBJECT (text_buffer), "insert-text", G_CALLBACK (linkify_insert_cb), NULL);
+      g_signal_connect_after (G_OBJECT (text_buffer), "delete-range", G_CALLBACK (linkify_delete_cb), NULL);
     }
 
+  if (options.text_data.ansi)
+    ansi_init ();
+
   gtk_container_add (GTK_CONTAINER (sw), tv);
 
+  if (options.text_data.pager)
+    g_signal_connect (G_OBJECT (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sw))),
+                      "value-changed", G_CALLBACK (pager_scroll_cb), NULL);
+
   /* create search bar */
   if (options.common_data.enable_search)
     {
-      if ((search_bar = create_search_bar ()) != NULL)
+      if ((search_bar = create_search_bar (TRUE)) != NULL)
         {
           gtk_box_pack_start (GTK_BOX (w), search_bar->bar, FALSE, FALSE, 0);
           g_signal_connect (G_OBJECT (search_bar->entry), "search-changed", G_CALLBACK (search_changed_cb), NULL);
+          g_signal_connect (G_OBJECT (search_bar->case_toggle), "toggled", G_CALLBACK (search_changed_cb), NULL);
           g_signal_connect (G_OBJECT (search_bar->entry), "stop-search", G_CALLBACK (stop_search_cb), NULL);
           g_signal_connect (G_OBJECT (search_bar->entry), "next-match", G_CALLBACK (do_find_next), NULL);
           g_signal_connect (G_OBJECT (search_bar->entry), "previous-match", G_CALLBACK (do_find_prev), NULL);
+
+          hit_tag = gtk_text_buffer_create_tag (GTK_TEXT_BUFFER (text_buffer), NULL,
+                                                "background", "yellow", "foreground", "black", NULL);
+          g_signal_connect (G_OBJECT (text_buffer), "changed", G_CALLBACK (search_text_changed_cb), NULL);
+          g_signal_connect_after (G_OBJECT (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (sw))),
+                                  "value-changed", G_CALLBACK (search_scroll_cb), NULL);
         }
     }
 
@@ -844,7 +2594,7 @@ text_create_widget (GtkWidget * dlg)
   if (options.common_data.uri)
     fill_buffer_from_file ();
 
-  if (options.common_data.listen || options.common_data.uri == NULL)
+  if ((options.common_data.listen && !options.text_data.pager) || options.common_data.uri == NULL)
     fill_buffer_from_stdin ();
 
   return w;
@@ -864,20 +2614,26 @@ text_print_result (void)
             {
               if (yad_confirm_dlg (GTK_WINDOW (gtk_widget_get_toplevel (text_view)),
                                    options.text_data.confirm_text))
-                save_file_cb (NULL, NULL);
+                save_text (TRUE);
             }
           else
-            save_file_cb (NULL, NULL);
+            save_text (TRUE);
         }
     }
   else
     {
-      GtkTextIter start, end;
+      GtkTextIter start;
+      GtkTextMark *pos;
       gchar *text;
 
-      gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (text_buffer), &start, &end);
-      text = gtk_text_buffer_get_text (GTK_TEXT_BUFFER (text_buffer), &start, &end, 0);
-      g_print ("%s", text);
-      g_free (text);
+      /* text is printed by slices, so it isn't copied at once */
+      gtk_text_buffer_get_start_iter (GTK_TEXT_BUFFER (text_buffer), &start);
+      pos = gtk_text_buffer_create_mark (GTK_TEXT_BUFFER (text_buffer), NULL, &start, TRUE);
+      while ((text = next_slice (pos)) != NULL)
+        {
+          g_print ("%s", text);
+          g_free (text);
+        }
+      gtk_text_buffer_delete_mark (GTK_TEXT_BUFFER (text_buffer), pos);
     }
 }
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <math.h>
 
 #include <sys/ipc.h>
 #include <sys/shm.h>
@@ -79,8 +80,88 @@ stock_lookup (const gchar *key, YadStock *it)
   return found;
 }
 
+/* pixbuf cache. pixbufs are shared between all users, so they must not be modified */
+typedef struct {
+  gchar *key;
+  GdkPixbuf *pb;
+  gsize size;
+  GList *link;
+} YadPixbufEntry;
+
+static GHashTable *pb_cache = NULL;
+static GQueue pb_lru = G_QUEUE_INIT;
+static gsize pb_cache_bytes = 0;
+
+static void
+pixbuf_entry_free (YadPixbufEntry *ent)
+{
+  g_free (ent->key);
+  g_object_unref (ent->pb);
+  g_free (ent);
+}
+
+/* returns new reference to cached pixbuf or NULL */
 GdkPixbuf *
-get_pixbuf (gchar *name, YadIconSize size, gboolean force)
+pixbuf_cache_lookup (const gchar *key)
+{
+  YadPixbufEntry *ent;
+
+  if (pb_cache == NULL)
+    return NULL;
+
+  ent = (YadPixbufEntry *) g_hash_table_lookup (pb_cache, key);
+  if (ent == NULL)
+    return NULL;
+
+  /* move to the head of lru list */
+  g_queue_unlink (&pb_lru, ent->link);
+  g_queue_push_head_link (&pb_lru, ent->link);
+
+  return g_object_ref (ent->pb);
+}
+
+void
+pixbuf_cache_insert (const gchar *key, GdkPixbuf *pb)
+{
+  YadPixbufEntry *ent;
+
+  if (pb == NULL)
+    return;
+
+  if (pb_cache == NULL)
+    pb_cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) pixbuf_entry_free);
+
+  ent = (YadPixbufEntry *) g_hash_table_lookup (pb_cache, key);
+  if (ent)
+    {
+      g_queue_delete_link (&pb_lru, ent->link);
+      pb_cache_bytes -= ent->size;
+      g_hash_table_remove (pb_cache, key);
+    }
+
+  ent = g_new0 (YadPixbufEntry, 1);
+  ent->key = g_strdup (key);
+  ent->pb = g_object_ref (pb);
+  ent->size = gdk_pixbuf_get_byte_length (pb);
+  g_queue_push_head (&pb_lru, ent);
+  ent->link = pb_lru.head;
+  g_hash_table_insert (pb_cache, ent->key, ent);
+  pb_cache_bytes += ent->size;
+
+  /* drop least recently used pixbufs. rows which use them keep their own references */
+  if (options.data.icon_cache > 0)
+    {
+      while (pb_cache_bytes > (gsize) options.data.icon_cache * 1024 && pb_lru.length > 1)
+        {
+          YadPixbufEntry *old = (YadPixbufEntry *) g_queue_pop_tail (&pb_lru);
+          pb_cache_bytes -= old->size;
+          g_hash_table_remove (pb_cache, old->key);
+        }
+    }
+}
+
+static GdkPixbuf *
+load_pixbuf (gchar *name, YadIconSize size, gboolean force)
 {
   gint w, h;
   GdkPixbuf *pb = NULL;
@@ -105,10 +186,9 @@ get_pixbuf (gchar *name, YadIconSize size, gboolean force)
 
   if (!pb)
     {
-      if (size == YAD_BIG_ICON)
-        pb = g_object_ref (big_fallback_image);
-      else
-        pb = g_object_ref (small_fallback_image);
+      GdkPixbuf *fb = (size == YAD_BIG_ICON) ? big_fallback_image : small_fallback_image;
+      if (fb)
+        pb = g_object_ref (fb);
     }
 
   /* force scaling image to specific size */
@@ -129,6 +209,64 @@ get_pixbuf (gchar *name, YadIconSize size, gboolean force)
   return pb;
 }
 
+/* names which can't be loaded at all. they are remembered too, so broken name
+   is not looked up again for each user */
+static GHashTable *pb_missing = NULL;
+
+/* force < 0 means images from files keeps their size and icons from theme are scaled */
+static GdkPixbuf *
+cached_pixbuf (const gchar *key, gchar *name, YadIconSize size, gint force)
+{
+  GdkPixbuf *pb;
+
+  pb = pixbuf_cache_lookup (key);
+  if (pb || (pb_missing && g_hash_table_contains (pb_missing, key)))
+    return pb;
+
+  if (force < 0)
+    force = !g_file_test (name, G_FILE_TEST_EXISTS);
+
+  pb = load_pixbuf (name, size, force);
+  if (pb)
+    pixbuf_cache_insert (key, pb);
+  else
+    {
+      if (pb_missing == NULL)
+        pb_missing = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      g_hash_table_add (pb_missing, g_strdup (key));
+    }
+
+  return pb;
+}
+
+GdkPixbuf *
+get_pixbuf (gchar *name, YadIconSize size, gboolean force)
+{
+  GdkPixbuf *pb;
+  gchar *key;
+
+  key = g_strdup_printf ("%d:%d:%s", size, force, name);
+  pb = cached_pixbuf (key, name, size, force);
+  g_free (key);
+
+  return pb;
+}
+
+/* images from files keeps their size, icons from theme are scaled.
+   file is checked only when image is not in cache yet */
+GdkPixbuf *
+get_image_pixbuf (gchar *name, YadIconSize size)
+{
+  GdkPixbuf *pb;
+  gchar *key;
+
+  key = g_strdup_printf ("%d:img:%s", size, name);
+  pb = cached_pixbuf (key, name, size, -1);
+  g_free (key);
+
+  return pb;
+}
+
 gchar *
 get_color (GdkRGBA *c)
 {
@@ -639,6 +777,918 @@ print_bool_val (gboolean val)
   return rv;
 }
 
+/* buffered output of dialog results. values are escaped directly into
+   the buffer, which goes to stdout in large blocks */
+#define OUTPUT_BUF_SIZE (256 * 1024)
+
+static GString *out_buf = NULL;
+static guint out_fields = 0;
+
+static void
+output_append_shell (const gchar *str)
+{
+  const gchar *p;
+
+  g_string_append_c (out_buf, '\'');
+  while ((p = strchr (str, '\'')) != NULL)
+    {
+      g_string_append_len (out_buf, str, p - str);
+      g_string_append_len (out_buf, "'\\''", 4);
+      str = p + 1;
+    }
+  g_string_append (out_buf, str);
+  g_string_append_c (out_buf, '\'');
+}
+
+static void
+output_append_csv (const gchar *str)
+{
+  const gchar *p;
+
+  /* quote only when needed (RFC 4180) */
+  if (str[strcspn (str, ",\"\r\n")] == '\0')
+    {
+      g_string_append (out_buf, str);
+      return;
+    }
+
+  g_string_append_c (out_buf, '"');
+  while ((p = strchr (str, '"')) != NULL)
+    {
+      g_string_append_len (out_buf, str, p - str + 1);
+      g_string_append_c (out_buf, '"');
+      str = p + 1;
+    }
+  g_string_append (out_buf, str);
+  g_string_append_c (out_buf, '"');
+}
+
+static void
+output_append_json (const gchar *str)
+{
+  const guchar *s, *p;
+
+  g_string_append_c (out_buf, '"');
+  for (s = p = (const guchar *) str; *p; p++)
+    {
+      if (*p >= 0x20 && *p != '"' && *p != '\\')
+        continue;
+
+      g_string_append_len (out_buf, (const gchar *) s, p - s);
+      switch (*p)
+        {
+        case '"':
+          g_string_append_len (out_buf, "\\\"", 2);
+          break;
+        case '\\':
+          g_string_append_len (out_buf, "\\\\", 2);
+          break;
+        case '\n':
+          g_string_append_len (out_buf, "\\n", 2);
+          break;
+        case '\r':
+          g_string_append_len (out_buf, "\\r", 2);
+          break;
+        case '\t':
+          g_string_append_len (out_buf, "\\t", 2);
+          break;
+        default:
+          g_string_append_printf (out_buf, "\\u%04x", *p);
+        }
+      s = p + 1;
+    }
+  g_string_append_len (out_buf, (const gchar *) s, p - s);
+  g_string_append_c (out_buf, '"');
+}
+
+static void
+output_field_start (void)
+{
+  if (out_buf == NULL)
+    out_buf = g_string_sized_new (OUTPUT_BUF_SIZE + 4096);
+  else if (out_buf->len >= OUTPUT_BUF_SIZE)
+    yad_output_flush ();
+
+  switch (options.common_data.output_fmt)
+    {
+    case YAD_OUTPUT_CSV:
+      if (out_fields)
+        g_string_append_c (out_buf, ',');
+      break;
+    case YAD_OUTPUT_JSON:
+      g_string_append_c (out_buf, out_fields ? ',' : '[');
+      break;
+    case YAD_OUTPUT_NUL:
+      if (out_fields)
+        g_string_append_c (out_buf, '\0');
+      break;
+    default:
+      if (out_fields)
+        g_string_append (out_buf, options.common_data.separator);
+    }
+  out_fields++;
+}
+
+/* output value which must not be quoted in json. in shell format it is quoted
+   only if quote is TRUE */
+static void
+output_literal (const gchar *str, gboolean quote)
+{
+  output_field_start ();
+
+  switch (options.common_data.output_fmt)
+    {
+    case YAD_OUTPUT_SHELL:
+      if (quote && options.common_data.quoted_output)
+        {
+          g_string_append_c (out_buf, '\'');
+          g_string_append (out_buf, str);
+          g_string_append_c (out_buf, '\'');
+        }
+      else
+        g_string_append (out_buf, str);
+      break;
+    case YAD_OUTPUT_CSV:
+      output_append_csv (str);
+      break;
+    default:
+      g_string_append (out_buf, str);
+    }
+}
+
+static void
+output_string (const gchar *str, gboolean quote)
+{
+  output_field_start ();
+
+  if (str == NULL)
+    str = "";
+
+  switch (options.common_data.output_fmt)
+    {
+    case YAD_OUTPUT_SHELL:
+      if (quote && options.common_data.quoted_output)
+        output_append_shell (str);
+      else
+        g_string_append (out_buf, str);
+      break;
+    case YAD_OUTPUT_NUL:
+      g_string_append (out_buf, str);
+      break;
+    case YAD_OUTPUT_CSV:
+      output_append_csv (str);
+      break;
+    case YAD_OUTPUT_JSON:
+      output_append_json (str);
+      break;
+    }
+}
+
+void
+yad_output_string (const gchar *str)
+{
+  output_string (str, TRUE);
+}
+
+/* string which is never quoted in shell format */
+void
+yad_output_plain (const gchar *str)
+{
+  output_string (str, FALSE);
+}
+
+void
+yad_output_int (gint64 val, gboolean quote)
+{
+  gchar buf[32];
+
+  g_snprintf (buf, sizeof (buf), "%" G_GINT64_FORMAT, val);
+  output_literal (buf, quote);
+}
+
+void
+yad_output_double (gdouble val, guint prec, gboolean quote)
+{
+  gchar buf[512];
+
+  if (options.common_data.output_fmt == YAD_OUTPUT_SHELL ||
+      options.common_data.output_fmt == YAD_OUTPUT_NUL)
+    g_snprintf (buf, sizeof (buf), "%.*f", prec, val);
+  else if (options.common_data.output_fmt == YAD_OUTPUT_JSON && !isfinite (val))
+    strcpy (buf, "null");
+  else
+    {
+      gchar fmt[16];
+
+      /* machine-readable formats always use dot as a decimal separator */
+      g_snprintf (fmt, sizeof (fmt), "%%.%uf", MIN (prec, 100));
+      g_ascii_formatd (buf, sizeof (buf), fmt, val);
+    }
+  output_literal (buf, quote);
+}
+
+void
+yad_output_bool (gboolean val)
+{
+  if (options.common_data.output_fmt == YAD_OUTPUT_JSON)
+    output_literal (val ? "true" : "false", TRUE);
+  else
+    output_literal (print_bool_val (val), TRUE);
+}
+
+/* finish current record. if sep is TRUE shell format gets separator after the last value as well.
+   in nul format each value is terminated by NUL and records are not delimited */
+void
+yad_output_row_end (gboolean sep)
+{
+  if (out_buf == NULL)
+    out_buf = g_string_sized_new (OUTPUT_BUF_SIZE + 4096);
+
+  switch (options.common_data.output_fmt)
+    {
+    case YAD_OUTPUT_NUL:
+      if (out_fields)
+        g_string_append_c (out_buf, '\0');
+      break;
+    case YAD_OUTPUT_CSV:
+      g_string_append_len (out_buf, "\r\n", 2);
+      break;
+    case YAD_OUTPUT_JSON:
+      if (out_fields == 0)
+        g_string_append_c (out_buf, '[');
+      g_string_append_len (out_buf, "]\n", 2);
+      break;
+    default:
+      if (sep && out_fields)
+        g_string_append (out_buf, options.common_data.separator);
+      g_string_append_c (out_buf, '\n');
+    }
+  out_fields = 0;
+}
+
+void
+yad_output_flush (void)
+{
+  if (out_buf && out_buf->len)
+    {
+      fwrite (out_buf->str, 1, out_buf->len, stdout);
+      g_string_truncate (out_buf, 0);
+    }
+  fflush (stdout);
+}
+
+/* streaming decoder of input data to utf-8. charset is detected once from the beginning of data,
+   pure ascii data is passed as is until the first non-ascii byte */
+#define DECODER_DETECT_MAX (64 * 1024)
+#define DECODER_CONV_BUF 16384
+
+struct _YadDecoder {
+  gchar *charset;
+  GConverter *conv;
+  GString *in;
+  GString *out;
+  gsize seen;
+  gboolean nul_sep;
+};
+
+/* windows-1252 characters in 0x80-0x9f range. other bytes are the same as in latin1 */
+static const gunichar cp1252[32] = {
+  0x20AC, 0xFFFD, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+  0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0xFFFD, 0x017D, 0xFFFD,
+  0xFFFD, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+  0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0xFFFD, 0x017E, 0x0178
+};
+
+static void
+decoder_set_charset (YadDecoder *dec, const gchar *charset)
+{
+  GError *err = NULL;
+
+  if (g_ascii_strcasecmp (charset, "UTF-8") != 0 && g_ascii_strcasecmp (charset, "UTF8") != 0)
+    {
+      dec->conv = (GConverter *) g_charset_converter_new ("UTF-8", charset, &err);
+      if (dec->conv == NULL)
+        {
+          g_printerr (_("Unknown encoding %s: %s\n"), charset, err->message);
+          g_error_free (err);
+          charset = "UTF-8";
+        }
+    }
+  dec->charset = g_strdup (charset);
+}
+
+static void
+decoder_detect (YadDecoder *dec)
+{
+  const guchar *p = (const guchar *) dec->in->str;
+  gsize len = dec->in->len, n, i, bom = 0;
+  guint zeros[2] = { 0, 0 }, invalid = 0, multi = 0;
+  const gchar *charset = NULL;
+
+  if (len >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF)
+    {
+      charset = "UTF-8";
+      bom = 3;
+    }
+  else if (len >= 2 && p[0] == 0xFF && p[1] == 0xFE)
+    {
+      charset = "UTF-16LE";
+      bom = 2;
+    }
+  else if (len >= 2 && p[0] == 0xFE && p[1] == 0xFF)
+    {
+      charset = "UTF-16BE";
+      bom = 2;
+    }
+
+  /* bom may appear only at the beginning of data */
+  if (bom && dec->seen == 0)
+    g_string_erase (dec->in, 0, bom);
+  if (charset)
+    {
+      decoder_set_charset (dec, charset);
+      return;
+    }
+
+  /* utf-16 without bom has zero high bytes in latin text. if nul is a separator of records,
+     such data isn't utf-16 */
+  n = dec->nul_sep ? 0 : MIN (len, 512);
+  for (i = 0; i < n; i++)
+    {
+      if (p[i] == 0)
+        zeros[i & 1]++;
+    }
+  if (n >= 8 && zeros[1] > n / 4 && zeros[0] == 0)
+    charset = "UTF-16LE";
+  else if (n >= 8 && zeros[0] > n / 4 && zeros[1] == 0)
+    charset = "UTF-16BE";
+  else
+    {
+      const gchar *s = (const gchar *) p, *e = s + MIN (len, DECODER_DETECT_MAX);
+
+      /* legacy text has high bytes which are not valid utf-8 sequences */
+      while (s < e)
+        {
+          gunichar c = g_utf8_get_char_validated (s, e - s);
+
+          if (c == (gunichar) -2)
+            break;
+          if (c == (gunichar) -1)
+            {
+              invalid++;
+              s++;
+            }
+          else
+            {
+              if ((guchar) *s >= 0x80)
+                multi++;
+              s = g_utf8_next_char (s);
+            }
+        }
+
+      /* otherwise it is in locale charset or in windows-1252 for utf-8 locales */
+      if (invalid == 0 || multi > 0)
+        charset = "UTF-8";
+      else if (g_get_charset (&charset))
+        charset = "WINDOWS-1252";
+    }
+
+  decoder_set_charset (dec, charset);
+}
+
+/* copy valid runs of utf-8 text. invalid bytes are taken as windows-1252 characters,
+   so mixed-encoding text stays readable. returns number of decoded bytes */
+static gsize
+decode_utf8 (GString *out, const gchar *p, gsize len, gboolean eof)
+{
+  const gchar *s = p, *e = p + len, *end;
+
+  while (s < e)
+    {
+      guchar c;
+
+      if (g_utf8_validate (s, e - s, &end))
+        {
+          g_string_append_len (out, s, e - s);
+          return len;
+        }
+      g_string_append_len (out, s, end - s);
+      s = end;
+
+      c = (guchar) *s;
+      if (c == 0)
+        {
+          /* nul is valid, but g_utf8_validate() stops at it */
+          g_string_append_c (out, '\0');
+          s++;
+          continue;
+        }
+
+      /* incomplete character at the end waits for the rest */
+      if (!eof && g_utf8_get_char_validated (s, e - s) == (gunichar) -2)
+        return s - p;
+
+      g_string_append_unichar (out, (c >= 0x80 && c < 0xA0) ? cp1252[c - 0x80] : c);
+      s++;
+    }
+
+  return len;
+}
+
+static gsize
+decode_conv (YadDecoder *dec, const gchar *p, gsize len, gboolean eof)
+{
+  gchar buf[DECODER_CONV_BUF];
+  gsize done = 0;
+
+  while (done < len || eof)
+    {
+      GConverterResult res;
+      GError *err = NULL;
+      gsize rd = 0, wr = 0;
+
+      res = g_converter_convert (dec->conv, p + done, len - done, buf, sizeof (buf),
+                                 eof ? G_CONVERTER_INPUT_AT_END : G_CONVERTER_NO_FLAGS, &rd, &wr, &err);
+      if (res == G_CONVERTER_ERROR)
+        {
+          /* incomplete character at the end waits for the rest */
+          if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT) && !eof)
+            {
+              g_error_free (err);
+              break;
+            }
+          g_error_free (err);
+          /* skip wrong byte */
+          g_string_append_unichar (dec->out, 0xFFFD);
+          if (done < len)
+            done++;
+          if (done >= len)
+            break;
+          continue;
+        }
+
+      g_string_append_len (dec->out, buf, wr);
+      done += rd;
+
+      if (res == G_CONVERTER_FINISHED)
+        {
+          g_converter_reset (dec->conv);
+          break;
+        }
+      if (rd == 0 && wr == 0)
+        break;
+    }
+
+  return done;
+}
+
+YadDecoder *
+yad_decoder_new (const gchar *charset, gboolean nul_sep)
+{
+  YadDecoder *dec = g_new0 (YadDecoder, 1);
+
+  dec->nul_sep = nul_sep;
+  dec->in = g_string_new (NULL);
+  dec->out = g_string_new (NULL);
+  if (charset && *charset)
+    decoder_set_charset (dec, charset);
+
+  return dec;
+}
+
+/* decode next portion of data. result is valid until the next call */
+const gchar *
+yad_decoder_feed (YadDecoder *dec, const gchar *buf, gsize len, gboolean eof, gsize *out_len)
+{
+  gsize done;
+
+  g_string_truncate (dec->out, 0);
+  g_string_append_len (dec->in, buf, len);
+
+  if (dec->charset == NULL)
+    {
+      const gchar *p = dec->in->str;
+      gsize i;
+
+      for (i = 0; i < dec->in->len && p[i] != 0 && (guchar) p[i] < 0x80; i++)
+        ;
+
+      /* ascii is the same in all supported charsets */
+      if (i == dec->in->len && !eof && dec->seen + i < DECODER_DETECT_MAX)
+        {
+          g_string_append_len (dec->out, p, i);
+          g_string_truncate (dec->in, 0);
+          dec->seen += i;
+          *out_len = dec->out->len;
+          return dec->out->str;
+        }
+      decoder_detect (dec);
+    }
+
+  if (dec->conv)
+    done = decode_conv (dec, dec->in->str, dec->in->len, eof);
+  else
+    done = decode_utf8 (dec->out, dec->in->str, dec->in->len, eof);
+  g_string_erase (dec->in, 0, done);
+
+  *out_len = dec->out->len;
+  return dec->out->str;
+}
+
+void
+yad_decoder_free (YadDecoder *dec)
+{
+  if (dec->conv)
+    g_object_unref (dec->conv);
+  g_free (dec->charset);
+  g_string_free (dec->in, TRUE);
+  g_string_free (dec->out, TRUE);
+  g_free (dec);
+}
+
+/* check if every newline byte is a line break, i.e. charset is not utf-16 or utf-32.
+   charset is known after the first non-ascii data is fed to decoder */
+gboolean
+yad_decoder_ascii_compatible (YadDecoder *dec)
+{
+  static const gchar *wide[] = { "UTF-16", "UTF16", "UTF-32", "UTF32", "UCS-2", "UCS2", "UCS-4", "UCS4", NULL };
+  gint i;
+
+  if (dec->charset == NULL)
+    return TRUE;
+
+  for (i = 0; wide[i]; i++)
+    {
+      if (g_ascii_strncasecmp (dec->charset, wide[i], strlen (wide[i])) == 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* framed stdin reader. records are parsed in place in a large buffer and passed
+   to consumer without copying */
+#define INPUT_BUF_SIZE (1024 * 1024)
+#define READ_CHUNK_SIZE (64 * 1024)
+
+typedef struct {
+  gint fd;
+  gchar *buf;
+  gsize size;
+  gsize start;
+  gsize end;
+  YadRecordFunc func;
+  GDestroyNotify done;
+  gpointer data;
+  YadDecoder *dec;
+} YadRecordReader;
+
+static gchar *
+next_record (YadRecordReader *rd, gsize *len, gboolean *bad)
+{
+  gchar *p = rd->buf + rd->start;
+  gsize avail = rd->end - rd->start;
+  gsize i = 0, n = 0;
+
+  if (options.common_data.input_fmt != YAD_INPUT_NETSTRING)
+    {
+      gchar sep = (options.common_data.input_fmt == YAD_INPUT_NUL) ? '\0' : '\n';
+      gchar *e = memchr (p, sep, avail);
+
+      if (e == NULL)
+        return NULL;
+      *e = '\0';
+      *len = e - p;
+      rd->start += *len + 1;
+      return p;
+    }
+
+  /* netstring "length:data," */
+  while (i < avail && (p[i] == '\n' || p[i] == '\r'))
+    i++;
+  rd->start += i;
+  p += i;
+  avail -= i;
+
+  for (i = 0; i < avail && g_ascii_isdigit (p[i]); i++)
+    {
+      if (i == 10)
+        {
+          *bad = TRUE;
+          return NULL;
+        }
+      n = n * 10 + (p[i] - '0');
+    }
+  if (i == avail)
+    return NULL;
+  if (i == 0 || p[i] != ':')
+    {
+      *bad = TRUE;
+      return NULL;
+    }
+  i++;
+
+  if (avail - i < n + 1)
+    return NULL;
+  if (p[i + n] != ',')
+    {
+      *bad = TRUE;
+      return NULL;
+    }
+
+  p[i + n] = '\0';
+  *len = n;
+  rd->start += i + n + 1;
+
+  return p + i;
+}
+
+static void
+append_data (YadRecordReader *rd, const gchar *p, gsize len)
+{
+  /* make room for new data. buffer grows only if a single record doesn't fit in it */
+  if (rd->start == rd->end)
+    rd->start = rd->end = 0;
+  if (rd->end + len > rd->size && rd->start > 0)
+    {
+      memmove (rd->buf, rd->buf + rd->start, rd->end - rd->start);
+      rd->end -= rd->start;
+      rd->start = 0;
+    }
+  if (rd->end + len > rd->size)
+    {
+      while (rd->end + len > rd->size)
+        rd->size *= 2;
+      rd->buf = g_realloc (rd->buf, rd->size + 1);
+    }
+
+  memcpy (rd->buf + rd->end, p, len);
+  rd->end += len;
+}
+
+static gboolean
+read_records_cb (GIOChannel *ch, GIOCondition cond, gpointer d)
+{
+  YadRecordReader *rd = (YadRecordReader *) d;
+  gboolean bad = FALSE;
+  gchar *rec;
+  gsize len;
+  gssize n;
+
+  gchar raw[READ_CHUNK_SIZE];
+  const gchar *p;
+
+  do
+    n = read (rd->fd, raw, sizeof (raw));
+  while (n < 0 && errno == EINTR);
+
+  if (n < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return TRUE;
+      g_printerr ("yad_read_records(): %s\n", g_strerror (errno));
+      goto done;
+    }
+  /* netstring lengths are in bytes, so such data is passed as is */
+  if (rd->dec)
+    p = yad_decoder_feed (rd->dec, raw, n, n == 0, &len);
+  else
+    {
+      p = raw;
+      len = n;
+    }
+  append_data (rd, p, len);
+
+  while ((rec = next_record (rd, &len, &bad)) != NULL)
+    {
+      if (!rd->func (rec, len, rd->data))
+        goto done;
+    }
+
+  if (bad)
+    {
+      g_printerr (_("yad_read_records(): malformed input record\n"));
+      goto done;
+    }
+
+  if (n == 0)
+    {
+      /* pass unterminated last record */
+      if (rd->start < rd->end && options.common_data.input_fmt != YAD_INPUT_NETSTRING)
+        {
+          rd->buf[rd->end] = '\0';
+          rd->func (rd->buf + rd->start, rd->end - rd->start, rd->data);
+        }
+      goto done;
+    }
+
+  return TRUE;
+
+ done:
+  if (rd->done)
+    rd->done (rd->data);
+  g_io_channel_shutdown (ch, FALSE, NULL);
+  if (rd->dec)
+    yad_decoder_free (rd->dec);
+  g_free (rd->buf);
+  g_free (rd);
+  return FALSE;
+}
+
+void
+yad_read_records (gint fd, YadRecordFunc func, GDestroyNotify done, gpointer data)
+{
+  YadRecordReader *rd;
+  GIOChannel *ch;
+
+  rd = g_new0 (YadRecordReader, 1);
+  rd->fd = fd;
+  rd->size = INPUT_BUF_SIZE;
+  rd->buf = g_malloc (rd->size + 1);
+  rd->func = func;
+  rd->done = done;
+  rd->data = data;
+  if (options.common_data.input_fmt != YAD_INPUT_NETSTRING)
+    rd->dec = yad_decoder_new (options.common_data.encoding,
+                               options.common_data.input_fmt == YAD_INPUT_NUL);
+
+  ch = g_io_channel_unix_new (fd);
+  g_io_channel_set_encoding (ch, NULL, NULL);
+  g_io_channel_set_flags (ch, G_IO_FLAG_NONBLOCK, NULL);
+  g_io_add_watch (ch, G_IO_IN | G_IO_HUP | G_IO_ERR, read_records_cb, rd);
+  g_io_channel_unref (ch);
+}
+
+/* file with extra arguments. it is mapped to memory and lines are taken from it on demand,
+   so the whole file is never copied to the heap. chunks of the file are indexed in parallel */
+#define REST_CHUNK_MIN (4 * 1024 * 1024)
+
+typedef struct {
+  const gchar *start;
+  const gchar *end;
+  guint lines;
+} RestChunk;
+
+static GMappedFile *rest_map = NULL;
+static const gchar *rest_data = NULL;
+static gsize rest_len = 0;
+static RestChunk *rest_chunks = NULL;
+static guint rest_n_chunks = 0;
+static guint rest_lines = 0;
+/* position of the next line for sequential reading */
+static guint rest_cur = 0;
+static const gchar *rest_ptr = NULL;
+
+static gpointer
+rest_count_lines (RestChunk *c)
+{
+  const gchar *p = c->start;
+
+  while (p < c->end && (p = memchr (p, '\n', c->end - p)) != NULL)
+    {
+      c->lines++;
+      p++;
+    }
+
+  return NULL;
+}
+
+gboolean
+yad_rest_open (const gchar *file)
+{
+  GError *err = NULL;
+  GThread **threads;
+  gsize chunk_size;
+  guint i;
+
+  rest_map = g_mapped_file_new (file, FALSE, &err);
+  if (rest_map == NULL)
+    {
+      g_printerr (_("Cannot open file '%s': %s\n"), file, err->message);
+      g_error_free (err);
+      return FALSE;
+    }
+  rest_data = g_mapped_file_get_contents (rest_map);
+  rest_len = g_mapped_file_get_length (rest_map);
+
+  rest_n_chunks = CLAMP (rest_len / REST_CHUNK_MIN, 1, g_get_num_processors ());
+  chunk_size = rest_len / rest_n_chunks;
+  rest_chunks = g_new0 (RestChunk, rest_n_chunks);
+  threads = g_new0 (GThread *, rest_n_chunks);
+
+  for (i = 0; i < rest_n_chunks; i++)
+    {
+      rest_chunks[i].start = rest_data + i * chunk_size;
+      rest_chunks[i].end = (i == rest_n_chunks - 1) ? rest_data + rest_len : rest_chunks[i].start + chunk_size;
+      if (i > 0)
+        threads[i] = g_thread_new ("rest_index", (GThreadFunc) rest_count_lines, &rest_chunks[i]);
+    }
+  rest_count_lines (&rest_chunks[0]);
+
+  for (i = 0; i < rest_n_chunks; i++)
+    {
+      if (threads[i])
+        g_thread_join (threads[i]);
+      rest_lines += rest_chunks[i].lines;
+    }
+  g_free (threads);
+
+  /* last line without newline */
+  if (rest_len > 0 && rest_data[rest_len - 1] != '\n')
+    rest_lines++;
+
+  rest_cur = 0;
+  rest_ptr = rest_data;
+
+  return TRUE;
+}
+
+guint
+yad_rest_count (void)
+{
+  return rest_lines;
+}
+
+/* get unescaped line n of the file. sequential reading is the fast path */
+gchar *
+yad_rest_get (guint n)
+{
+  const gchar *end;
+  gchar *line, *res;
+
+  if (n >= rest_lines)
+    return NULL;
+
+  if (n != rest_cur)
+    {
+      guint i, first = 0;
+
+      /* chunk may start in the middle of the line, so start from the line after
+         first newline in the nearest chunk before the needed line */
+      rest_ptr = rest_data;
+      rest_cur = 0;
+      for (i = 0; i < rest_n_chunks && first < n; i++)
+        {
+          end = memchr (rest_chunks[i].start, '\n', rest_data + rest_len - rest_chunks[i].start);
+          if (end == NULL)
+            break;
+          rest_ptr = end + 1;
+          rest_cur = first + 1;
+          first += rest_chunks[i].lines;
+        }
+      for (; rest_cur < n; rest_cur++)
+        {
+          end = memchr (rest_ptr, '\n', rest_data + rest_len - rest_ptr);
+          rest_ptr = end ? end + 1 : rest_data + rest_len;
+        }
+    }
+
+  end = memchr (rest_ptr, '\n', rest_data + rest_len - rest_ptr);
+  if (end == NULL)
+    end = rest_data + rest_len;
+
+  line = g_strndup (rest_ptr, end - rest_ptr);
+  res = g_strcompress (line);
+  g_free (line);
+
+  rest_ptr = (end < rest_data + rest_len) ? end + 1 : end;
+  rest_cur = n + 1;
+
+  return res;
+}
+
+/* all lines as an array for dialogs which needs it */
+gchar **
+yad_rest_strv (void)
+{
+  gchar **res;
+  guint i;
+
+  if (rest_lines == 0)
+    return NULL;
+
+  res = g_new0 (gchar *, rest_lines + 1);
+  for (i = 0; i < rest_lines; i++)
+    res[i] = yad_rest_get (i);
+
+  return res;
+}
+
+void
+yad_rest_close (void)
+{
+  if (rest_map == NULL)
+    return;
+
+  g_mapped_file_unref (rest_map);
+  rest_map = NULL;
+  rest_data = NULL;
+  rest_len = rest_lines = 0;
+  g_free (rest_chunks);
+  rest_chunks = NULL;
+  rest_n_chunks = 0;
+}
+
 typedef struct {
   gchar *cmd;
   gchar **out;
@@ -696,6 +1746,64 @@ run_command_sync (gchar *cmd, gchar **out)
   return ret;
 }
 
+typedef struct {
+  gchar *cmd;
+  gchar *out;
+  gboolean need_out;
+  gint ret;
+  YadCommandFunc func;
+  gpointer data;
+} RunCbData;
+
+static gboolean
+run_cb_done (RunCbData *d)
+{
+  d->func (d->ret, d->out, d->data);
+  g_free (d->out);
+  g_free (d->cmd);
+  g_free (d);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+run_cb_thread (RunCbData *d)
+{
+  GError *err = NULL;
+
+  if (!g_spawn_command_line_sync (d->cmd, d->need_out ? &d->out : NULL, NULL, &d->ret, &err))
+    {
+      if (options.debug)
+        g_printerr (_("WARNING: Run command failed: %s\n"), err->message);
+      g_error_free (err);
+      d->ret = -1;
+    }
+  g_idle_add ((GSourceFunc) run_cb_done, d);
+}
+
+/* run command in background thread. func is called in main loop when command finished */
+void
+run_command_cb (gchar *cmd, gboolean need_out, YadCommandFunc func, gpointer data)
+{
+  RunCbData *d;
+
+  d = g_new0 (RunCbData, 1);
+
+  if (options.data.use_interp)
+    {
+      if (g_strstr_len (options.data.interp, -1, "%s") != NULL)
+        d->cmd = g_strdup_printf (options.data.interp, cmd);
+      else
+        d->cmd = g_strdup_printf ("%s %s", options.data.interp, cmd);
+    }
+  else
+    d->cmd = g_strdup (cmd);
+  d->need_out = need_out;
+  d->func = func;
+  d->data = data;
+
+  g_thread_unref (g_thread_new ("run_cb", (GThreadFunc) run_cb_thread, d));
+}
+
 void
 run_command_async (gchar *cmd)
 {
@@ -722,6 +1830,72 @@ run_command_async (gchar *cmd)
   g_free (full_cmd);
 }
 
+static void
+pipe_child_exit (GPid pid, gint status, gpointer data)
+{
+  g_spawn_close_pid (pid);
+}
+
+static void
+new_group_setup (gpointer data)
+{
+  setpgid (0, 0);
+}
+
+static GPid
+spawn_command (gchar *cmd, gint *out, GChildWatchFunc exit_cb, gpointer data, gboolean new_group)
+{
+  gchar *full_cmd = NULL;
+  gchar **argv = NULL;
+  GPid pid = 0;
+  GError *err = NULL;
+
+  if (options.data.use_interp)
+    {
+      if (g_strstr_len (options.data.interp, -1, "%s") != NULL)
+        full_cmd = g_strdup_printf (options.data.interp, cmd);
+      else
+        full_cmd = g_strdup_printf ("%s %s", options.data.interp, cmd);
+    }
+  else
+    full_cmd = g_strdup (cmd);
+
+  if (!g_shell_parse_argv (full_cmd, NULL, &argv, &err) ||
+      !g_spawn_async_with_pipes (NULL, argv, NULL, G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD,
+                                 new_group ? new_group_setup : NULL, NULL, &pid, NULL, out, NULL, &err))
+    {
+      if (options.debug)
+        g_printerr (_("WARNING: Run command failed: %s\n"), err->message);
+      g_error_free (err);
+      pid = 0;
+    }
+  else if (exit_cb)
+    g_child_watch_add (pid, exit_cb, data);
+  else
+    g_child_watch_add (pid, pipe_child_exit, NULL);
+
+  g_strfreev (argv);
+  g_free (full_cmd);
+
+  return pid;
+}
+
+/* run command asynchronously. if out is not NULL, stdout of the command is connected to the pipe.
+   if exit_cb is set, it must close pid. returns pid of the child or 0 on error */
+GPid
+run_command_pipe (gchar *cmd, gint *out, GChildWatchFunc exit_cb, gpointer data)
+{
+  return spawn_command (cmd, out, exit_cb, data, FALSE);
+}
+
+/* same as run_command_pipe, but the command runs in its own process group.
+   pid of the child is the id of the group, so the whole group can be terminated */
+GPid
+run_command_group (gchar *cmd, gint *out, GChildWatchFunc exit_cb, gpointer data)
+{
+  return spawn_command (cmd, out, exit_cb, data, TRUE);
+}
+
 gchar *
 pango_to_css (gchar *font)
 {
@@ -850,8 +2024,23 @@ case_toggle_cb (GtkToggleButton *b, YadSearchBar *sb)
   gtk_toggle_button_set_active (b, sb->case_sensitive);
 }
 
+static void
+regex_toggle_cb (GtkToggleButton *b, YadSearchBar *sb)
+{
+  sb->regex = gtk_toggle_button_get_active (b);
+  g_signal_emit_by_name (sb->entry, "search-changed");
+}
+
+static void
+word_toggle_cb (GtkToggleButton *b, YadSearchBar *sb)
+{
+  sb->whole_word = gtk_toggle_button_get_active (b);
+  g_signal_emit_by_name (sb->entry, "search-changed");
+}
+
+/* full search bar has regex and whole word modes and label for number of matches */
 YadSearchBar *
-create_search_bar ()
+create_search_bar (gboolean full)
 {
   YadSearchBar *sb;
   GtkWidget *b;
@@ -891,6 +2080,24 @@ create_search_bar ()
 
   g_signal_connect (G_OBJECT (sb->case_toggle), "toggled", G_CALLBACK (case_toggle_cb), sb);
 
+  if (full)
+    {
+      sb->word_toggle = gtk_check_button_new_with_mnemonic (_("_Whole words"));
+      gtk_widget_set_focus_on_click (sb->word_toggle, FALSE);
+      gtk_box_pack_start (GTK_BOX (b), sb->word_toggle, FALSE, FALSE, 0);
+
+      g_signal_connect (G_OBJECT (sb->word_toggle), "toggled", G_CALLBACK (word_toggle_cb), sb);
+
+      sb->regex_toggle = gtk_check_button_new_with_mnemonic (_("_Regex"));
+      gtk_widget_set_focus_on_click (sb->regex_toggle, FALSE);
+      gtk_box_pack_start (GTK_BOX (b), sb->regex_toggle, FALSE, FALSE, 0);
+
+      g_signal_connect (G_OBJECT (sb->regex_toggle), "toggled", G_CALLBACK (regex_toggle_cb), sb);
+
+      sb->count = gtk_label_new (NULL);
+      gtk_box_pack_start (GTK_BOX (b), sb->count, FALSE, FALSE, 2);
+    }
+
   return sb;
 }
 
@@ -192,6 +192,19 @@ typedef enum {
   YAD_BOOL_FMT_1
 } YadBoolFormat;
 
+typedef enum {
+  YAD_OUTPUT_SHELL = 0,
+  YAD_OUTPUT_NUL,
+  YAD_OUTPUT_CSV,
+  YAD_OUTPUT_JSON
+} YadOutputFormat;
+
+typedef enum {
+  YAD_INPUT_LINES = 0,
+  YAD_INPUT_NUL,
+  YAD_INPUT_NETSTRING
+} YadInputFormat;
+
 typedef struct {
   gchar *name;
   gchar *cmd;
@@ -210,6 +223,7 @@ typedef struct {
   gboolean wrap;
   gboolean ellipsize;
   gboolean editable;
+  gint width;
   gdouble c_align;
   gdouble h_align;
 } YadColumn;
@@ -255,6 +269,7 @@ typedef struct {
   gboolean always_print;
   gboolean selectable_labels;
   gboolean keep_icon_size;
+  guint icon_cache;
   GtkButtonBoxStyle buttons_layout;
   gint def_resp;
   gboolean use_interp;
@@ -399,16 +414,24 @@ typedef struct {
   gint sep_column;
   gchar *sep_value;
   guint limit;
+  gint key_column;
   gchar *editable_cols;
   gint wrap_width;
   gchar *wrap_cols;
   PangoEllipsizeMode ellipsize;
   gchar *ellipsize_cols;
+  gboolean fixed_layout;
+  gchar *col_widths;
   gchar *dclick_action;
   gchar *select_action;
   gchar *row_action;
+  guint action_delay;
   gboolean tree_expanded;
+  gchar *tree_loader;
+  gboolean tree_unload;
   gboolean regex_search;
+  gboolean live_filter;
+  gchar *sort_by;
   gboolean clickable;
   gboolean no_selection;
   gboolean add_on_top;
@@ -473,6 +496,7 @@ typedef struct {
   gboolean log_expanded;
   gboolean log_on_top;
   gint log_height;
+  gboolean list_view;
 } YadProgressData;
 
 typedef struct {
@@ -504,6 +528,9 @@ typedef struct {
   gboolean in_place;
   gboolean confirm_save;
   gchar *confirm_text;
+  guint max_lines;
+  gboolean pager;
+  gboolean ansi;
 } YadTextData;
 
 #ifdef HAVE_SOURCEVIEW
@@ -555,6 +582,9 @@ typedef struct {
   GFormatSizeFlags size_fmt;
 #endif
   YadBoolFormat bool_fmt;
+  YadOutputFormat output_fmt;
+  YadInputFormat input_fmt;
+  gchar *encoding;
   YadCompletionType complete;
   GList *filters;
   key_t key;
@@ -665,7 +695,12 @@ typedef struct {
   GtkWidget *next;
   GtkWidget *prev;
   GtkWidget *case_toggle;
+  GtkWidget *regex_toggle;
+  GtkWidget *word_toggle;
+  GtkWidget *count;
   gboolean case_sensitive;
+  gboolean regex;
+  gboolean whole_word;
   gboolean new_search;
   const gchar *str;
 } YadSearchBar;
@@ -769,6 +804,9 @@ void paned_close_childs (void);
 void update_preview (GtkFileChooser *chooser, GtkWidget *p);
 
 GdkPixbuf *get_pixbuf (gchar *name, YadIconSize size, gboolean force);
+GdkPixbuf *get_image_pixbuf (gchar *name, YadIconSize size);
+GdkPixbuf *pixbuf_cache_lookup (const gchar *key);
+void pixbuf_cache_insert (const gchar *key, GdkPixbuf *pb);
 gchar *get_color (GdkRGBA *c);
 
 gchar **split_arg (const gchar *str);
@@ -789,14 +827,43 @@ void parse_geometry ();
 gboolean get_bool_val (gchar *str);
 gchar *print_bool_val (gboolean val);
 
+void yad_output_string (const gchar *str);
+void yad_output_plain (const gchar *str);
+void yad_output_int (gint64 val, gboolean quote);
+void yad_output_double (gdouble val, guint prec, gboolean quote);
+void yad_output_bool (gboolean val);
+void yad_output_row_end (gboolean sep);
+void yad_output_flush (void);
+
+/* handler of framed input record. str is NUL-terminated and valid only during the call */
+typedef gboolean (*YadRecordFunc) (gchar *str, gsize len, gpointer data);
+void yad_read_records (gint fd, YadRecordFunc func, GDestroyNotify done, gpointer data);
+
+/* incremental decoder of input data to utf-8 */
+typedef struct _YadDecoder YadDecoder;
+YadDecoder *yad_decoder_new (const gchar *charset, gboolean nul_sep);
+const gchar *yad_decoder_feed (YadDecoder *dec, const gchar *buf, gsize len, gboolean eof, gsize *out_len);
+void yad_decoder_free (YadDecoder *dec);
+gboolean yad_decoder_ascii_compatible (YadDecoder *dec);
+
+gboolean yad_rest_open (const gchar *file);
+guint yad_rest_count (void);
+gchar *yad_rest_get (guint n);
+gchar **yad_rest_strv (void);
+void yad_rest_close (void);
+
 gint run_command_sync (gchar *cmd, gchar **out);
 void run_command_async (gchar *cmd);
+GPid run_command_pipe (gchar *cmd, gint *out, GChildWatchFunc exit_cb, gpointer data);
+GPid run_command_group (gchar *cmd, gint *out, GChildWatchFunc exit_cb, gpointer data);
+typedef void (*YadCommandFunc) (gint ret, gchar *out, gpointer data);
+void run_command_cb (gchar *cmd, gboolean need_out, YadCommandFunc func, gpointer data);
 
 gchar *pango_to_css (gchar *font);
 
 void open_uri (const gchar *uri);
 
-YadSearchBar *create_search_bar ();
+YadSearchBar *create_search_bar (gboolean full);
 
 gboolean yad_confirm_dlg (GtkWindow *parent, gchar *txt);
 